@@ -0,0 +1,18 @@
+#version 330 core
+
+in vec3 position;
+
+layout(std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    mat4 view_projection;
+    mat4 ortho;
+    vec4 light_position;
+    float time;
+};
+
+uniform mat4 model;
+
+void main() {
+    gl_Position = view_projection * model * vec4(position, 1.0);
+}
@@ -2,6 +2,8 @@
 
 in vec3 position;
 in vec3 normal;
+in vec3 color;      // per instance
+in mat4 model;      // per instance
 
 out vec3 eye_cameraspace;
 out vec3 lightdirection_cameraspace;
@@ -9,21 +11,27 @@ out vec3 normal_cameraspace;
 out vec3 position0;
 out vec3 col;
 
-uniform mat4 mvp;
-uniform mat4 view;
-uniform vec3 light;
-uniform vec3 color;
+layout(std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    mat4 view_projection;
+    mat4 ortho;
+    vec4 light_position;
+    float time;
+};
 
 void main() {
     col = color;
 
-    vec3 position_cameraspace = (view * vec4(position, 1.0)).xyz;
+    vec4 position_worldspace = model * vec4(position, 1.0);
+
+    vec3 position_cameraspace = (view * position_worldspace).xyz;
     eye_cameraspace = vec3(0,0,0) - position_cameraspace;
 
-    vec3 light_cameraspace = (view * vec4(light, 0)).xyz;
+    vec3 light_cameraspace = (view * vec4(light_position.xyz, 0)).xyz;
     lightdirection_cameraspace = light_cameraspace + eye_cameraspace;
 
-    normal_cameraspace = (view * vec4(normal, 1.0)).xyz;
+    normal_cameraspace = (view * model * vec4(normal, 0.0)).xyz;
 
-    gl_Position = mvp * vec4(position, 1.0);
+    gl_Position = view_projection * position_worldspace;
 }
@@ -6,9 +6,16 @@ in vec3 color;
 
 out vec3 col;
 
-uniform mat4 mvp;
+layout(std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    mat4 view_projection;
+    mat4 ortho;
+    vec4 light_position;
+    float time;
+};
 
 void main() {
     col = color;
-    gl_Position = mvp * vec4(position, 1.0);
+    gl_Position = view_projection * vec4(position, 1.0);
 }
@@ -5,9 +5,18 @@ in vec2 texture_coordinate;
 
 out vec2 texcoord;
 
-uniform mat4 mvp;
+layout(std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    mat4 view_projection;
+    mat4 ortho;
+    vec4 light_position;
+    float time;
+};
+
+uniform vec3 offset;    // position of the glyph in pixels
 
 void main() {
-    gl_Position = mvp * vec4(position.xy, 0.0, 1.0);
+    gl_Position = ortho * vec4(position.xy + offset.xy, offset.z, 1.0);
     texcoord = texture_coordinate;
 }
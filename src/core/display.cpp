@@ -102,12 +102,12 @@ Display::Display() {
     }
 
     // enable transparency
-    glEnable (GL_BLEND);
+    GLState::get().enable(GL_BLEND);
     glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // enable culling
-    glEnable(GL_CULL_FACE);
-    glEnable(GL_DEPTH_TEST);
+    GLState::get().enable(GL_CULL_FACE);
+    GLState::get().enable(GL_DEPTH_TEST);
 
     // disable cursor (we are going to use our own)
     //glfwSetInputMode(this->m_window, GLFW_CURSOR, GLFW_CURSOR_HIDDEN);
@@ -209,7 +209,8 @@ void Display::error_callback(int error, const char* description) {
  *
  */
 void Display::key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
-    Visualizer::get().handle_key_down(key, scancode, action, mods);
+    InputEvent event = {InputEvent::KEY, key, scancode, action, mods, 0.0, 0.0};
+    InputQueue::get().push(event);
 }
 
 /**
@@ -222,7 +223,8 @@ void Display::key_callback(GLFWwindow* window, int key, int scancode, int action
  *
  */
 void Display::mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
-    Visualizer::get().handle_mouse_key_down(button, action, mods);
+    InputEvent event = {InputEvent::MOUSE_BUTTON, button, 0, action, mods, 0.0, 0.0};
+    InputQueue::get().push(event);
 }
 
 /**
@@ -234,7 +236,8 @@ void Display::mouse_button_callback(GLFWwindow* window, int button, int action,
  *
  */
 void Display::scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
-    Visualizer::get().handle_scroll(xoffset, yoffset);
+    InputEvent event = {InputEvent::SCROLL, 0, 0, 0, 0, xoffset, yoffset};
+    InputQueue::get().push(event);
 }
 
 /**
@@ -258,7 +261,8 @@ void Display::drop_callback(GLFWwindow* window, int count, const char** paths) {
  *
  */
 void Display::mouse_cursor_callback(GLFWwindow* window, double xpos, double ypos) {
-    Visualizer::get().handle_mouse_cursor(xpos, ypos);
+    InputEvent event = {InputEvent::CURSOR, 0, 0, 0, 0, xpos, ypos};
+    InputQueue::get().push(event);
 }
 
 /**
@@ -269,7 +273,8 @@ void Display::mouse_cursor_callback(GLFWwindow* window, double xpos, double ypos
  *
  */
 void Display::char_callback(GLFWwindow* window, unsigned int key) {
-    Visualizer::get().handle_char_callback(key);
+    InputEvent event = {InputEvent::CHARACTER, (int)key, 0, 0, 0, 0.0, 0.0};
+    InputQueue::get().push(event);
 }
 
 /**
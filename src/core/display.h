@@ -29,6 +29,8 @@
 #include <boost/format.hpp>
 
 #include "core/camera.h"
+#include "core/gl_state.h"
+#include "core/input_queue.h"
 #include "core/visualizer.h"
 #include "core/screen.h"
 #include "core/post_processor.h"
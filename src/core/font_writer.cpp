@@ -29,11 +29,11 @@ FontWriter::FontWriter() : texture_slot(FONT_TEXTURE_SLOT) {
     this->shader = std::shared_ptr<Shader>(new Shader("assets/shaders/text_sdf"));
     this->shader->add_attribute(ShaderAttribute::POSITION, "position");
     this->shader->add_attribute(ShaderAttribute::TEXTURE_COORDINATE, "texture_coordinate");
-    this->shader->add_uniform(ShaderUniform::MAT4, "mvp", 1);
-    this->shader->add_uniform(ShaderUniform::VEC3, "textcolor", 1);
-    this->shader->add_uniform(ShaderUniform::TEXTURE, "text", 1);
-    this->shader->add_uniform(ShaderUniform::FLOAT, "width", 1);
-    this->shader->add_uniform(ShaderUniform::FLOAT, "edge", 1);
+    this->shader->add_uniform<ShaderUniform::VEC3>("offset", 1);
+    this->shader->add_uniform<ShaderUniform::VEC3>("textcolor", 1);
+    this->shader->add_uniform<ShaderUniform::TEXTURE>("text", 1);
+    this->shader->add_uniform<ShaderUniform::FLOAT>("width", 1);
+    this->shader->add_uniform<ShaderUniform::FLOAT>("edge", 1);
 }
 
 /**
@@ -113,6 +113,12 @@ FontWriter::CharacterAtlas::CharacterAtlas(const std::string& font_file, unsigne
     this->sdf_width = _width;
     this->sdf_edge = _edge;
 
+    this->uniform_offset = this->shader->get_uniform_handle<ShaderUniform::VEC3>("offset");
+    this->uniform_textcolor = this->shader->get_uniform_handle<ShaderUniform::VEC3>("textcolor");
+    this->uniform_text = this->shader->get_uniform_handle<ShaderUniform::TEXTURE>("text");
+    this->uniform_width = this->shader->get_uniform_handle<ShaderUniform::FLOAT>("width");
+    this->uniform_edge = this->shader->get_uniform_handle<ShaderUniform::FLOAT>("edge");
+
     FT_Library library;         //!< FreeType library
     if(FT_Init_FreeType(&library)) {
         std::cerr << "FT_Init_FreeType failed" << std::endl;
@@ -140,28 +146,24 @@ void FontWriter::CharacterAtlas::write_text(float x, float y, float z, const glm
         return;
     }
 
-    const glm::mat4 projection = glm::ortho(0.0f,
-                                      (float)Screen::get().get_resolution_x(),
-                                      0.0f,
-                                      (float)Screen::get().get_resolution_y());
-
+    // the projection onto the screen is taken from the per-frame uniform block
     float xx = x;
     float yy = y;
 
     const float scale = pt / (float)this->base_font_size;
 
-    // load the texture
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, this->texture);
-
-    // load the vertex array
-    glBindVertexArray(this->vao);
-
-    this->shader->link_shader();
-    this->shader->set_uniform("textcolor", &color[0]);
-    this->shader->set_uniform("text", &this->texture_slot);
-    this->shader->set_uniform("width", &this->sdf_width);
-    this->shader->set_uniform("edge", &this->sdf_edge);
+    DrawItem item = DrawItem();
+    item.program = this->shader->get_program();
+    item.texture_unit = this->texture_slot;
+    item.texture = this->texture;
+    item.vao = this->vao;
+    item.mode = GL_TRIANGLE_STRIP;
+    item.count = 4;
+    item.prepare = &CharacterAtlas::prepare_glyph;
+    item.owner = this;
+    item.data[3] = color[0];
+    item.data[4] = color[1];
+    item.data[5] = color[2];
 
     auto it = line.begin();
     auto end = line.end();
@@ -181,21 +183,31 @@ void FontWriter::CharacterAtlas::write_text(float x, float y, float z, const glm
         float cxx = xx;
         float cyy = yy;// + (this->glyphs[c - this->cstart].height -this->glyphs[c - this->cstart].vertical_bearing) * scale;
 
-        glm::mat4 mvp = glm::translate(projection, glm::vec3(cxx, cyy, z + count / 1e6f));
-
-        this->shader->set_uniform("mvp", &mvp[0][0]);
+        item.data[0] = cxx;
+        item.data[1] = cyy;
+        item.data[2] = z + count / 1e6f;
 
         // draw the mesh using the indices
-        glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (GLvoid*) (sizeof(GL_UNSIGNED_INT) * (c - this->cstart) * 4));
+        item.offset = (GLvoid*) (sizeof(GL_UNSIGNED_INT) * (c - this->cstart) * 4);
+        RenderQueue::get().submit(RenderQueue::PASS_GUI, 0, item);
 
          xx += this->glyphs[c - this->cstart].horizontal_advance * scale;
 
     } while(it < end);
+}
 
-    // after this command, any commands that use a vertex array will
-    // no longer work
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+/**
+ * @brief Upload the uniforms of a glyph just before it is drawn by the render queue
+ *
+ * @param[in]   item    draw item; data holds the offset (0-2) and the color (3-5)
+ */
+void FontWriter::CharacterAtlas::prepare_glyph(const DrawItem& item) {
+    const CharacterAtlas* atlas = static_cast<const CharacterAtlas*>(item.owner);
+
+    atlas->shader->set_uniform(atlas->uniform_offset, &item.data[0]);
+    atlas->shader->set_uniform(atlas->uniform_textcolor, &item.data[3]);
+    atlas->shader->set_uniform(atlas->uniform_width, &atlas->sdf_width);
+    atlas->shader->set_uniform(atlas->uniform_edge, &atlas->sdf_edge);
 }
 
 /**
@@ -239,99 +251,58 @@ void FontWriter::CharacterAtlas::static_load() {
     const float scale = this->pt / (float)this->base_font_size;
     const float pts = scale * (float)this->font_padding;
 
-    this->positions.clear();
-    this->texture_coordinates.clear();
-    this->indices.clear();
+    std::vector<VertexPT> vertices;
+    std::vector<unsigned int> indices;
 
     for(unsigned int c=0; c<this->ccount; c++) {
 
         const float fx = (float)this->glyphs[c].horizontal_bearing * scale;
         const float fy = -(float)(this->glyphs[c].height - this->glyphs[c].vertical_bearing) * scale;
 
-        this->positions.push_back(glm::vec2(fx - pts, fy + pts + (float)this->glyphs[c].height * scale));
-        this->positions.push_back(glm::vec2(fx - pts, fy - pts));
-        this->positions.push_back(glm::vec2(fx + pts + (float)this->glyphs[c].width * scale, fy + pts + (float)this->glyphs[c].height * scale));
-        this->positions.push_back(glm::vec2(fx + pts + (float)this->glyphs[c].width * scale, fy - pts));
-
-        this->texture_coordinates.push_back(glm::vec2(this->glyphs[c].tx1, this->glyphs[c].ty2));
-        this->texture_coordinates.push_back(glm::vec2(this->glyphs[c].tx1, this->glyphs[c].ty1));
-        this->texture_coordinates.push_back(glm::vec2(this->glyphs[c].tx2, this->glyphs[c].ty2));
-        this->texture_coordinates.push_back(glm::vec2(this->glyphs[c].tx2, this->glyphs[c].ty1));
+        const float x1 = fx - pts;
+        const float x2 = fx + pts + (float)this->glyphs[c].width * scale;
+        const float y1 = fy - pts;
+        const float y2 = fy + pts + (float)this->glyphs[c].height * scale;
 
-        this->indices.push_back(this->positions.size()-4);
-        this->indices.push_back(this->positions.size()-3);
-        this->indices.push_back(this->positions.size()-2);
-        this->indices.push_back(this->positions.size()-1);
+        add_quad(&vertices, &indices,
+                 glm::vec4(x1, y1, x2, y2),
+                 glm::vec4(this->glyphs[c].tx1, this->glyphs[c].ty1, this->glyphs[c].tx2, this->glyphs[c].ty2));
     }
 
-    this->positions.push_back(glm::vec2(0, this->texture_height));
-    this->positions.push_back(glm::vec2(0, 0));
-    this->positions.push_back(glm::vec2(this->texture_width, this->texture_height));
-    this->positions.push_back(glm::vec2(this->texture_width, 0));
-
-    this->texture_coordinates.push_back(glm::vec2(0,0));
-    this->texture_coordinates.push_back(glm::vec2(0,1));
-    this->texture_coordinates.push_back(glm::vec2(1,0));
-    this->texture_coordinates.push_back(glm::vec2(1,1));
-
-    this->indices.push_back(this->positions.size()-4);
-    this->indices.push_back(this->positions.size()-3);
-    this->indices.push_back(this->positions.size()-2);
-    this->indices.push_back(this->positions.size()-1);
-
-    glGenVertexArrays(1, &this->vao);
-
-    // generate a vertex array object and store it in the pointer
-    glBindVertexArray(this->vao);
-
-    // generate a number of buffers (blocks of data on the GPU)
-    glGenBuffers(3, this->vbo);
-
-    /*
-     * POSITIONS
-     */
-
-    // bind a buffer identified by POSITION_VB and interpret this buffer as an array
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[0]);
-    // fill the buffer with data
-    glBufferData(GL_ARRAY_BUFFER, this->positions.size() * 2 * sizeof(float), &this->positions[0][0], GL_STATIC_DRAW);
-
-    // specifies the generic vertex attribute of index 0 to be enabled
-    glEnableVertexAttribArray(0);
-    // define an array of generic vertex attribute data
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
-
-    /*
-     * TEXTURE COORDINATES
-     */
-
-    // up the vertex_id
-    // bind a buffer identified by POSITION_VB and interpret this buffer as an array
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[1]);
-    // fill the buffer with data
-    glBufferData(GL_ARRAY_BUFFER, this->texture_coordinates.size() * 2 * sizeof(float), &this->texture_coordinates[0][0], GL_STATIC_DRAW);
+    // the full texture, upside down (used to display the charmap)
+    add_quad(&vertices, &indices,
+             glm::vec4(0, 0, this->texture_width, this->texture_height),
+             glm::vec4(0, 1, 1, 0));
 
-    // specifies the generic vertex attribute of index 0 to be enabled
-    glEnableVertexAttribArray(1);
-    // define an array of generic vertex attribute data
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0);
-
-    /*
-     * INDICES_VB
-     */
-
-    // bind a buffer identified by INDICES_VB and interpret this buffer as an array
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo[2]);
-    // fill the buffer with data
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->indices.size() * sizeof(unsigned int), &this->indices[0], GL_STATIC_DRAW);
+    // positions and texture coordinates are interleaved in a single buffer
+    LayoutPT::load_indexed(&this->vao, this->vbo, vertices, indices);
 
     if(!this->shader->is_loaded()) {
         this->shader->bind_uniforms_and_attributes();
+
+        // all atlases share the texture slot
+        this->shader->set_uniform(this->uniform_text, &this->texture_slot);
     }
+}
 
-    // after this command, any commands that use a vertex array will
-    // no longer work
-    glBindVertexArray(0);
+/**
+ * @brief Append a quad (drawn as a triangle strip) to the vertex and index lists
+ *
+ * @param vertices              vertex list
+ * @param indices               index list
+ * @param rect                  screen rectangle (x1, y1, x2, y2)
+ * @param tex                   texture rectangle (x1, y1, x2, y2)
+ */
+void FontWriter::CharacterAtlas::add_quad(std::vector<VertexPT>* vertices, std::vector<unsigned int>* indices,
+                                          const glm::vec4& rect, const glm::vec4& tex) {
+    const unsigned int corners[4][2] = {{0, 3}, {0, 1}, {2, 3}, {2, 1}};
+    for(unsigned int i=0; i<4; i++) {
+        VertexPT vertex;
+        vertex.position = glm::vec2(rect[corners[i][0]], rect[corners[i][1]]);
+        vertex.texture_coordinate = glm::vec2(tex[corners[i][0]], tex[corners[i][1]]);
+        indices->push_back(vertices->size());
+        vertices->push_back(vertex);
+    }
 }
 
 /**
@@ -350,12 +321,16 @@ FontWriter::CharacterAtlas::CharacterAtlas(const FontWriter::CharacterAtlas& oth
     cstart(other.cstart),
     ccount(other.ccount),
     shader(other.shader),
-    texture_slot(FONT_TEXTURE_SLOT) {
+    texture_slot(FONT_TEXTURE_SLOT),
+    uniform_offset(other.uniform_offset),
+    uniform_textcolor(other.uniform_textcolor),
+    uniform_text(other.uniform_text),
+    uniform_width(other.uniform_width),
+    uniform_edge(other.uniform_edge) {
 
     this->vao = other.vao;
     this->vbo[0] = other.vbo[0];
     this->vbo[1] = other.vbo[1];
-    this->vbo[2] = other.vbo[2];
 }
 
 /**
@@ -374,17 +349,20 @@ FontWriter::CharacterAtlas::CharacterAtlas(FontWriter::CharacterAtlas&& other) n
     cstart(other.cstart),
     ccount(other.ccount),
     shader(other.shader),
-    texture_slot(FONT_TEXTURE_SLOT) {
+    texture_slot(FONT_TEXTURE_SLOT),
+    uniform_offset(other.uniform_offset),
+    uniform_textcolor(other.uniform_textcolor),
+    uniform_text(other.uniform_text),
+    uniform_width(other.uniform_width),
+    uniform_edge(other.uniform_edge) {
 
     this->vao = other.vao;
     this->vbo[0] = other.vbo[0];
     this->vbo[1] = other.vbo[1];
-    this->vbo[2] = other.vbo[2];
 
     other.vao = 0;
     other.vbo[0] = 0;
     other.vbo[1] = 0;
-    other.vbo[2] = 0;
 }
 
 FontWriter::CharacterAtlas::~CharacterAtlas() {
@@ -510,23 +488,17 @@ void FontWriter::CharacterAtlas::generate_character_map(const std::string& filen
         unsigned int gy = 0;
         unsigned int gx = 0;
 
+        // place the glyphs on the char map
+        std::vector<unsigned int> offsets_x(this->ccount);
+        std::vector<unsigned int> offsets_y(this->ccount);
         counter = 0;
         for(unsigned int i=this->cstart; i<this->cstart+this->ccount; i++) {
             counter++;
             const unsigned int width = this->glyphs[i - this->cstart].width + 2 * this->font_padding;
             const unsigned int height = this->glyphs[i - this->cstart].height + 2 * this->font_padding;
 
-            std::vector<uint8_t> distance_field(width * height, 0.0f);
-            this->calculate_distance_field(distance_field,
-                                           char_bitmaps[i-this->cstart],
-                                           width,
-                                           height);
-
-            for(unsigned int k=0; k<height; k++) {
-                for(unsigned int l=0; l<width; l++){
-                    this->expanded_data[(l+gx)+(k+gy)*img_width] = distance_field[l + width*k];
-                }
-            }
+            offsets_x[i - this->cstart] = gx;
+            offsets_y[i - this->cstart] = gy;
 
             this->glyphs[i - this->cstart].tx1 = (float)gx / (float)img_width;
             this->glyphs[i - this->cstart].tx2 = (float)(gx + width) / (float)img_width;
@@ -543,14 +515,35 @@ void FontWriter::CharacterAtlas::generate_character_map(const std::string& filen
             }
         }
 
+        // calculate the distance fields of the glyphs in parallel; every glyph
+        // writes to its own part of the char map
+        JobSystem::get().parallel_for(0, this->ccount, 1, [&](size_t begin, size_t end) {
+            for(size_t i=begin; i<end; i++) {
+                const unsigned int width = this->glyphs[i].width + 2 * this->font_padding;
+                const unsigned int height = this->glyphs[i].height + 2 * this->font_padding;
+
+                std::vector<uint8_t> distance_field(width * height, 0.0f);
+                this->calculate_distance_field(distance_field,
+                                               char_bitmaps[i],
+                                               width,
+                                               height);
+
+                for(unsigned int k=0; k<height; k++) {
+                    for(unsigned int l=0; l<width; l++){
+                        this->expanded_data[(l+offsets_x[i])+(k+offsets_y[i])*img_width] = distance_field[l + width*k];
+                    }
+                }
+            }
+        });
+
         // save result to assets
         PNG::write_image_buffer_to_png(filename + ".png", this->expanded_data, this->texture_width, this->texture_height, PNG_COLOR_TYPE_GRAY, true);
     }
 
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glActiveTexture(GL_TEXTURE1);
+    GLState::get().active_texture(GL_TEXTURE1);
     glGenTextures(1, &this->texture);
-    glBindTexture(GL_TEXTURE_2D, this->texture);
+    GLState::get().bind_texture(GL_TEXTURE_2D, this->texture);
     glTexImage2D(
         GL_TEXTURE_2D,
         0,
@@ -566,7 +559,7 @@ void FontWriter::CharacterAtlas::generate_character_map(const std::string& filen
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::get().bind_texture(GL_TEXTURE_2D, 0);
 }
 
 /**
@@ -639,31 +632,19 @@ std::vector<bool> FontWriter::CharacterAtlas::unpack_mono_bitmap(FT_Bitmap bitma
  * @brief Display the complete character map (font atlas) on the screen (used for debugging purposes)
  */
 void FontWriter::CharacterAtlas::draw_charmap_on_screen() {
-    const glm::mat4 projection = glm::ortho(0.0f,
-                                      (float)Screen::get().get_resolution_x(),
-                                      0.0f,
-                                      (float)Screen::get().get_resolution_y());
-
-    // load the texture
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, this->texture);
-
-    // load the vertex array
-    glBindVertexArray(this->vao);
-
-    glm::vec3 color(1,1,1);
-
-    this->shader->link_shader();
-    this->shader->set_uniform("mvp", &projection[0][0]);
-    this->shader->set_uniform("textcolor", &color[0]);
-    this->shader->set_uniform("text", &this->texture_slot);
-    this->shader->set_uniform("width", &this->sdf_width);
-    this->shader->set_uniform("edge", &this->sdf_edge);
-
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (GLvoid*) (sizeof(GL_UNSIGNED_INT) * this->ccount * 4));
-
-    // after this command, any commands that use a vertex array will
-    // no longer work
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    DrawItem item = DrawItem();
+    item.program = this->shader->get_program();
+    item.texture_unit = this->texture_slot;
+    item.texture = this->texture;
+    item.vao = this->vao;
+    item.mode = GL_TRIANGLE_STRIP;
+    item.count = 4;
+    item.offset = (GLvoid*) (sizeof(GL_UNSIGNED_INT) * this->ccount * 4);
+    item.prepare = &CharacterAtlas::prepare_glyph;
+    item.owner = this;
+    item.data[3] = 1.0f;
+    item.data[4] = 1.0f;
+    item.data[5] = 1.0f;
+
+    RenderQueue::get().submit(RenderQueue::PASS_GUI, 0, item);
 }
@@ -28,6 +28,7 @@
 #include <string>
 
 #include "util/pngfuncs.h"
+#include "core/job_system.h"
 
 #include <sys/stat.h>
 #include <ft2build.h>
@@ -40,6 +41,8 @@
 #include "core/asset_manager.h"
 #include "core/camera.h"
 #include "shader.h"
+#include "render_queue.h"
+#include "vertex_layout.h"
 #include "screen.h"
 #include "util/utf8.h"
 #include "util/mathfunc.h"
@@ -104,11 +107,7 @@ private:
         std::vector<Glyph> glyphs;                      //!< vector holding collection of glyphs
 
         GLuint vao;                                     //!< reference of the VAO
-        GLuint vbo[3];                                  //!< reference to the VBO
-
-        std::vector<unsigned int> indices;              //!< vector holding indices for the screen characters
-        std::vector<glm::vec2> positions;               //!< vector holding screen character positions
-        std::vector<glm::vec2> texture_coordinates;     //!< vector holding texture coordinates for the screen characters
+        GLuint vbo[2];                                  //!< reference to the VBO (vertices and indices)
 
         unsigned int pt;                                //!< point size of the font
         float sdf_width;                                //!< shading width for the signed distance field shader
@@ -128,6 +127,12 @@ private:
         std::shared_ptr<Shader> shader;                 //!< shader for drawing the font
         const unsigned int texture_slot;                //!< fixed texture where fonts are stored
 
+        UniformHandle<ShaderUniform::VEC3> uniform_offset;      //!< position of the glyph in pixels
+        UniformHandle<ShaderUniform::VEC3> uniform_textcolor;   //!< color of the text
+        UniformHandle<ShaderUniform::TEXTURE> uniform_text;     //!< texture holding the atlas
+        UniformHandle<ShaderUniform::FLOAT> uniform_width;      //!< shading width of the sdf
+        UniformHandle<ShaderUniform::FLOAT> uniform_edge;       //!< edge width of the sdf
+
     public:
         /*
          * @brief       CharacterAtlas constructor
@@ -215,6 +220,24 @@ private:
          * @brief Load the characters on the GPU
          */
         void static_load();
+
+        /**
+         * @brief Append a quad (drawn as a triangle strip) to the vertex and index lists
+         *
+         * @param vertices              vertex list
+         * @param indices               index list
+         * @param rect                  screen rectangle (x1, y1, x2, y2)
+         * @param tex                   texture rectangle (x1, y1, x2, y2)
+         */
+        static void add_quad(std::vector<VertexPT>* vertices, std::vector<unsigned int>* indices,
+                             const glm::vec4& rect, const glm::vec4& tex);
+
+        /**
+         * @brief Upload the uniforms of a glyph just before it is drawn by the render queue
+         *
+         * @param[in]   item    draw item; data holds the offset (0-2) and the color (3-5)
+         */
+        static void prepare_glyph(const DrawItem& item);
     };
 
     const unsigned int texture_slot;                //!< fixed texture where fonts are stored
@@ -0,0 +1,61 @@
+/**************************************************************************
+ *   frame_data.cpp  --  This file is part of Acardov.                    *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+#include "core/frame_data.h"
+
+const GLuint FrameData::BINDING_POINT;
+const char* const FrameData::BLOCK_NAME = "FrameData";
+
+FrameData::FrameData() {
+    this->block = FrameBlock();
+
+    glGenBuffers(1, &this->ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, this->ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameBlock), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, this->ubo);
+}
+
+/**
+ * @brief       gather the camera, light and time of this frame and upload them
+ *
+ * @param       time    time since the start of the program in seconds
+ */
+void FrameData::update(double time) {
+    const Camera& camera = Camera::get();
+
+    this->block.projection = camera.get_projection();
+    this->block.view = camera.get_view();
+    this->block.view_projection = this->block.projection * this->block.view;
+    this->block.ortho = glm::ortho(0.0f,
+                                   (float)Screen::get().get_resolution_x(),
+                                   0.0f,
+                                   (float)Screen::get().get_resolution_y());
+    this->block.light_position = glm::vec4(Light::get().get_position(), 1.0f);
+    this->block.time = (float)time;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, this->ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameBlock), &this->block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+FrameData::~FrameData() {
+    glDeleteBuffers(1, &this->ubo);
+}
@@ -0,0 +1,112 @@
+/**************************************************************************
+ *   frame_data.h  --  This file is part of Acardov.                      *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+#ifndef _FRAME_DATA_H
+#define _FRAME_DATA_H
+
+#include <GL/glew.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "core/camera.h"
+#include "core/light.h"
+#include "core/screen.h"
+
+/**
+ * @struct FrameBlock
+ * @brief  contents of the FrameData uniform block (std140 layout)
+ *
+ * Every shader that needs any of these values declares the block as
+ *
+ *     layout(std140) uniform FrameData {
+ *         mat4 projection;
+ *         mat4 view;
+ *         mat4 view_projection;
+ *         mat4 ortho;
+ *         vec4 light_position;
+ *         float time;
+ *     };
+ */
+struct FrameBlock {
+    glm::mat4 projection;       //!< camera projection
+    glm::mat4 view;             //!< camera view
+    glm::mat4 view_projection;  //!< projection * view
+    glm::mat4 ortho;            //!< pixel coordinates to clip space (for the gui)
+    glm::vec4 light_position;   //!< light position in world space (w is unused)
+    float time;                 //!< time since the start of the program in seconds
+    float padding[3];           //!< std140 rounds the size of a block up to 16 bytes
+};
+
+static_assert(sizeof(FrameBlock) == 288, "FrameBlock does not match the std140 layout of FrameData");
+
+/**
+ * @class FrameData
+ * @brief Uniform buffer holding the data that is the same for every draw in a frame
+ *
+ * The buffer is filled once per frame and bound to a fixed binding point;
+ * Shader::bind_uniforms_and_attributes attaches every program declaring the
+ * block to that binding point, such that the draws only upload their
+ * per-object uniforms.
+ */
+class FrameData {
+public:
+    static const GLuint BINDING_POINT = 0;      //!< uniform buffer binding point of the block
+    static const char* const BLOCK_NAME;        //!< name of the block in the shaders
+
+private:
+    GLuint ubo;             //!< uniform buffer object
+    FrameBlock block;       //!< contents of the current frame
+
+public:
+    /**
+     * @fn          get
+     *
+     * @brief       get a reference to the frame data
+     *
+     * @return      reference to the frame data object (singleton pattern)
+     */
+    static FrameData& get() {
+        static FrameData frame_data_instance;
+        return frame_data_instance;
+    }
+
+    /**
+     * @brief       gather the camera, light and time of this frame and upload them
+     *
+     * Call after the camera and the light have been updated for the frame.
+     *
+     * @param       time    time since the start of the program in seconds
+     */
+    void update(double time);
+
+    inline const FrameBlock& get_block() const {
+        return this->block;
+    }
+
+    ~FrameData();
+
+private:
+    FrameData();
+
+    FrameData(FrameData const&)          = delete;
+    void operator=(FrameData const&)  = delete;
+};
+
+#endif //_FRAME_DATA_H
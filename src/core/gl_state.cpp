@@ -0,0 +1,162 @@
+/**************************************************************************
+ *   gl_state.cpp  --  This file is part of Acardov.                      *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+#include "core/gl_state.h"
+
+const unsigned int GLState::MAX_TEXTURE_UNITS;
+const GLuint GLState::UNKNOWN;
+
+GLState::GLState() :
+    nr_calls(0),
+    nr_calls_eliminated(0) {
+    this->invalidate();
+}
+
+void GLState::use_program(GLuint id) {
+    if(this->update(&this->program, id)) {
+        glUseProgram(id);
+    }
+}
+
+void GLState::bind_vertex_array(GLuint id) {
+    if(this->update(&this->vertex_array, id)) {
+        glBindVertexArray(id);
+    }
+}
+
+/**
+ * @brief       select the active texture unit
+ *
+ * @param       unit    GL_TEXTURE0, GL_TEXTURE1, ...
+ */
+void GLState::active_texture(GLenum unit) {
+    if(this->update(&this->active_unit, unit - GL_TEXTURE0)) {
+        glActiveTexture(unit);
+    }
+}
+
+/**
+ * @brief       bind a texture to the active texture unit
+ *
+ * @param       target  texture target
+ * @param       id      texture
+ */
+void GLState::bind_texture(GLenum target, GLuint id) {
+    const int t = get_texture_target(target);
+    if(t < 0 || this->active_unit >= MAX_TEXTURE_UNITS) {
+        this->nr_calls++;
+        glBindTexture(target, id);
+        return;
+    }
+
+    if(this->update(&this->textures[this->active_unit][t], id)) {
+        glBindTexture(target, id);
+    }
+}
+
+void GLState::bind_framebuffer(GLenum target, GLuint id) {
+    switch(target) {
+        case GL_READ_FRAMEBUFFER:
+            if(this->update(&this->read_framebuffer, id)) {
+                glBindFramebuffer(target, id);
+            }
+        break;
+        case GL_DRAW_FRAMEBUFFER:
+            if(this->update(&this->draw_framebuffer, id)) {
+                glBindFramebuffer(target, id);
+            }
+        break;
+        default:
+            // GL_FRAMEBUFFER binds both
+            this->nr_calls++;
+            if(this->read_framebuffer == id && this->draw_framebuffer == id) {
+                this->nr_calls_eliminated++;
+            } else {
+                this->read_framebuffer = id;
+                this->draw_framebuffer = id;
+                glBindFramebuffer(target, id);
+            }
+        break;
+    }
+}
+
+void GLState::enable(GLenum capability) {
+    const int c = get_capability(capability);
+    if(c < 0) {
+        this->nr_calls++;
+        glEnable(capability);
+    } else if(this->update(&this->capabilities[c], GL_TRUE)) {
+        glEnable(capability);
+    }
+}
+
+void GLState::disable(GLenum capability) {
+    const int c = get_capability(capability);
+    if(c < 0) {
+        this->nr_calls++;
+        glDisable(capability);
+    } else if(this->update(&this->capabilities[c], GL_FALSE)) {
+        glDisable(capability);
+    }
+}
+
+/**
+ * @brief       forget the shadow copy, such that the next calls are all passed on
+ */
+void GLState::invalidate() {
+    this->program = UNKNOWN;
+    this->vertex_array = UNKNOWN;
+    this->active_unit = UNKNOWN;
+    for(unsigned int i=0; i<MAX_TEXTURE_UNITS; i++) {
+        for(unsigned int j=0; j<NR_TEXTURE_TARGETS; j++) {
+            this->textures[i][j] = UNKNOWN;
+        }
+    }
+    this->read_framebuffer = UNKNOWN;
+    this->draw_framebuffer = UNKNOWN;
+    for(unsigned int i=0; i<NR_CAPABILITIES; i++) {
+        this->capabilities[i] = UNKNOWN;
+    }
+}
+
+int GLState::get_texture_target(GLenum target) {
+    switch(target) {
+        case GL_TEXTURE_2D:
+            return TARGET_TEXTURE_2D;
+        case GL_TEXTURE_2D_MULTISAMPLE:
+            return TARGET_TEXTURE_2D_MULTISAMPLE;
+        default:
+            return -1;
+    }
+}
+
+int GLState::get_capability(GLenum capability) {
+    switch(capability) {
+        case GL_BLEND:
+            return CAP_BLEND;
+        case GL_DEPTH_TEST:
+            return CAP_DEPTH_TEST;
+        case GL_CULL_FACE:
+            return CAP_CULL_FACE;
+        case GL_MULTISAMPLE:
+            return CAP_MULTISAMPLE;
+        default:
+            return -1;
+    }
+}
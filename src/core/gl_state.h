@@ -0,0 +1,159 @@
+/**************************************************************************
+ *   gl_state.h  --  This file is part of Acardov.                        *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+#ifndef _GL_STATE_H
+#define _GL_STATE_H
+
+#include <GL/glew.h>
+
+/**
+ * @class GLState
+ * @brief Shadow copy of the bound GL objects and switches
+ *
+ * All binds of programs, vertex arrays, textures and frame buffers and the
+ * toggling of blending, depth testing, face culling and multisampling go
+ * through this class. A call that would not change the state is dropped
+ * before it reaches the driver. Hence the code may bind whatever it needs
+ * without having to worry about redundant calls; unbinding after a draw is
+ * only needed where a following call depends on nothing being bound.
+ *
+ * Any of these calls made directly to GL would leave the shadow copy out of
+ * date; call invalidate() after doing so (or after deleting an object that
+ * may still be bound).
+ */
+class GLState {
+public:
+    static const unsigned int MAX_TEXTURE_UNITS = 16;
+
+private:
+    static const GLuint UNKNOWN = 0xFFFFFFFF;       //!< state that has not been set through this class
+
+    enum {
+        TARGET_TEXTURE_2D,
+        TARGET_TEXTURE_2D_MULTISAMPLE,
+
+        NR_TEXTURE_TARGETS
+    };
+
+    enum {
+        CAP_BLEND,
+        CAP_DEPTH_TEST,
+        CAP_CULL_FACE,
+        CAP_MULTISAMPLE,
+
+        NR_CAPABILITIES
+    };
+
+    GLuint program;                                             //!< program in use
+    GLuint vertex_array;                                        //!< bound vertex array
+    GLuint active_unit;                                         //!< active texture unit (0 for GL_TEXTURE0)
+    GLuint textures[MAX_TEXTURE_UNITS][NR_TEXTURE_TARGETS];     //!< bound texture per unit and target
+    GLuint read_framebuffer;                                    //!< frame buffer bound for reading
+    GLuint draw_framebuffer;                                    //!< frame buffer bound for drawing
+    GLuint capabilities[NR_CAPABILITIES];                       //!< switches (GL_TRUE, GL_FALSE or UNKNOWN)
+
+    unsigned long int nr_calls;                 //!< calls made through this class
+    unsigned long int nr_calls_eliminated;      //!< calls that were dropped
+
+public:
+    /**
+     * @fn          get
+     *
+     * @brief       get a reference to the GL state
+     *
+     * @return      reference to the GL state object (singleton pattern)
+     */
+    static GLState& get() {
+        static GLState gl_state_instance;
+        return gl_state_instance;
+    }
+
+    void use_program(GLuint id);
+
+    void bind_vertex_array(GLuint id);
+
+    /**
+     * @brief       select the active texture unit
+     *
+     * @param       unit    GL_TEXTURE0, GL_TEXTURE1, ...
+     */
+    void active_texture(GLenum unit);
+
+    /**
+     * @brief       bind a texture to the active texture unit
+     *
+     * @param       target  texture target
+     * @param       id      texture
+     */
+    void bind_texture(GLenum target, GLuint id);
+
+    void bind_framebuffer(GLenum target, GLuint id);
+
+    void enable(GLenum capability);
+
+    void disable(GLenum capability);
+
+    /**
+     * @brief       forget the shadow copy, such that the next calls are all passed on
+     */
+    void invalidate();
+
+    inline unsigned long int get_nr_calls() const {
+        return this->nr_calls;
+    }
+
+    inline unsigned long int get_nr_calls_eliminated() const {
+        return this->nr_calls_eliminated;
+    }
+
+    inline void reset_counters() {
+        this->nr_calls = 0;
+        this->nr_calls_eliminated = 0;
+    }
+
+private:
+    GLState();
+
+    /**
+     * @brief       record a call and decide whether it has to be passed on
+     *
+     * @param       current     shadow copy of the state (updated)
+     * @param       value       requested state
+     *
+     * @return      whether the call changes the state
+     */
+    inline bool update(GLuint* current, GLuint value) {
+        this->nr_calls++;
+        if(*current == value) {
+            this->nr_calls_eliminated++;
+            return false;
+        }
+        *current = value;
+        return true;
+    }
+
+    static int get_texture_target(GLenum target);
+
+    static int get_capability(GLenum capability);
+
+    GLState(GLState const&)          = delete;
+    void operator=(GLState const&)  = delete;
+};
+
+#endif //_GL_STATE_H
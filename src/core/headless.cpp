@@ -0,0 +1,94 @@
+/**************************************************************************
+ *   headless.cpp  --  This file is part of Acardov.                      *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "headless.h"
+
+#include <chrono>
+
+#include "game/game.h"
+#include "game/replay.h"
+
+Headless::Headless() :
+    flag_enabled(false) {}
+
+/**
+ * @brief       update the game a number of times without rendering
+ *
+ * @param       nr_ticks        number of updates
+ * @param       dt              game time per update in seconds
+ */
+void Headless::run(unsigned long int nr_ticks, double dt) {
+    this->flag_enabled = true;
+
+    // build the world before starting the clock; a benchmark must not
+    // overwrite the autosave of the player
+    Game::get().set_autosave_enabled(false);
+
+    // the search of the AI is normally bounded by wall-clock time, hence its
+    // moves would depend on the load of the machine; bounded by rollouts
+    // instead, two runs of the same binary reach the same state (and hash)
+    Game::get().set_ai_deterministic(true);
+
+    const auto start = std::chrono::steady_clock::now();
+    for(unsigned long int i=0; i<nr_ticks; i++) {
+        Game::get().update(dt);
+    }
+    Planet::get().get_simulation().finish();
+    const auto stop = std::chrono::steady_clock::now();
+
+    const double elapsed = std::chrono::duration<double>(stop - start).count();
+    std::cout << "Performed " << nr_ticks << " updates (" << Planet::get().get_simulation().get_nr_ticks()
+              << " simulation ticks) in " << elapsed << " seconds: "
+              << (double)nr_ticks / elapsed << " updates per second" << std::endl;
+}
+
+/**
+ * @brief       fast-forward through a recorded match
+ *
+ * @param       filename        path to the command log
+ * @param       update          update to stop at (the end of the recording when larger)
+ *
+ * @return      whether the replay could be played
+ */
+bool Headless::replay(const std::string& filename, unsigned long int update) {
+    this->flag_enabled = true;
+
+    Replay replay;
+    if(!replay.load(filename)) {
+        return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    replay.seek(update);
+    Planet::get().get_simulation().finish();
+    const auto stop = std::chrono::steady_clock::now();
+
+    const double elapsed = std::chrono::duration<double>(stop - start).count();
+    std::cout << "Replayed " << replay.get_position() << " of " << replay.get_log().get_nr_updates()
+              << " updates (" << replay.get_log().get_nr_commands() << " commands) in " << elapsed << " seconds: "
+              << (double)replay.get_position() / elapsed << " updates per second" << std::endl;
+
+    if(replay.get_desync_update() != 0) {
+        std::cout << "The replay diverged from the recording at update " << replay.get_desync_update() << std::endl;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,82 @@
+/**************************************************************************
+ *   headless.h  --  This file is part of Acardov.                        *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _HEADLESS_H
+#define _HEADLESS_H
+
+#include <iostream>
+#include <string>
+
+/**
+ * @class Headless
+ * @brief Runs the game simulation without a window or GL context
+ *
+ * In headless mode the planet and the game state are built without
+ * uploading anything to the GPU, and the game is updated as fast as
+ * possible. This is used for AI self-play, balancing runs and testing.
+ */
+class Headless {
+private:
+    bool flag_enabled;      //!< whether the program runs headless
+
+public:
+    /**
+     * @brief       get a reference to the headless runner
+     *
+     * @return      reference to the headless object (singleton pattern)
+     */
+    static Headless& get() {
+        static Headless headless_instance;
+        return headless_instance;
+    }
+
+    /**
+     * @brief       update the game a number of times without rendering
+     *
+     * @param       nr_ticks        number of updates
+     * @param       dt              game time per update in seconds
+     */
+    void run(unsigned long int nr_ticks, double dt);
+
+    /**
+     * @brief       fast-forward through a recorded match
+     *
+     * @param       filename        path to the command log
+     * @param       update          update to stop at (the end of the recording when larger)
+     *
+     * @return      whether the replay could be played
+     */
+    bool replay(const std::string& filename, unsigned long int update);
+
+    /**
+     * @brief       whether graphics should be skipped
+     */
+    inline bool is_enabled() const {
+        return this->flag_enabled;
+    }
+
+private:
+    Headless();
+
+    Headless(Headless const&)          = delete;
+    void operator=(Headless const&)    = delete;
+};
+
+#endif //_HEADLESS_H
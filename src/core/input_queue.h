@@ -0,0 +1,180 @@
+/**************************************************************************
+ *   input_queue.h  --  This file is part of Acardov.                     *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+#ifndef _INPUT_QUEUE_H
+#define _INPUT_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @class SpscRing
+ * @brief Lock-free ring buffer for a single producer and a single consumer
+ *
+ * The producer only writes the tail and the consumer only writes the head,
+ * so both sides proceed without locks. The capacity has to be a power of two
+ * such that the indices can be wrapped with a mask; one slot is kept empty
+ * to tell a full ring from an empty one.
+ */
+template <typename T, size_t N>
+class SpscRing {
+private:
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+    T items[N];                     //!< storage
+
+    std::atomic<size_t> head;       //!< next slot to read (written by the consumer)
+    std::atomic<size_t> tail;       //!< next slot to write (written by the producer)
+
+public:
+    SpscRing() : head(0), tail(0) {}
+
+    /**
+     * @brief      place an item in the ring (producer side)
+     *
+     * @param      item  item to place
+     *
+     * @return     false when the ring is full and the item is dropped
+     */
+    bool push(const T& item) {
+        const size_t t = this->tail.load(std::memory_order_relaxed);
+        const size_t next = (t + 1) & (N - 1);
+        if(next == this->head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        this->items[t] = item;
+        this->tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief      take the oldest item from the ring (consumer side)
+     *
+     * @param      item  receives the item
+     *
+     * @return     false when the ring is empty
+     */
+    bool pop(T* item) {
+        const size_t h = this->head.load(std::memory_order_relaxed);
+        if(h == this->tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *item = this->items[h];
+        this->head.store((h + 1) & (N - 1), std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief      whether the ring holds no items
+     */
+    inline bool empty() const {
+        return this->head.load(std::memory_order_acquire) ==
+               this->tail.load(std::memory_order_acquire);
+    }
+};
+
+/**
+ * @struct InputEvent
+ * @brief  input event as received from the window system
+ */
+struct InputEvent {
+    enum {
+        KEY,            //!< keyboard key (key, scancode, action, mods)
+        MOUSE_BUTTON,   //!< mouse button (key holds the button, action, mods)
+        CURSOR,         //!< cursor position (x, y)
+        SCROLL,         //!< scroll offsets (x, y)
+        CHARACTER,      //!< unicode character (key holds the code point)
+
+        NR_TYPES
+    };
+
+    unsigned int type;
+    int key;
+    int scancode;
+    int action;
+    int mods;
+    double x;
+    double y;
+};
+
+/**
+ * @class InputQueue
+ * @brief Hands input events from the window callbacks to the simulation
+ *
+ * The window callbacks only push events; the visualizer drains the queue
+ * once per update. This decouples the rate at which the devices report
+ * (a gaming mouse easily reports at 1000 Hz) from the rate at which the
+ * camera and the game respond to them.
+ */
+class InputQueue {
+private:
+    SpscRing<InputEvent, 4096> ring;        //!< pending events
+
+    unsigned int nr_dropped;                //!< events lost to a full ring (producer side)
+
+public:
+    /**
+     * @fn InputQueue get
+     * @brief Returns reference to InputQueue instance
+     *
+     * @return reference to input queue instance
+     */
+    static InputQueue& get() {
+        static InputQueue instance;
+        return instance;
+    }
+
+    /**
+     * @brief      queue an event (window callbacks only)
+     *
+     * @param      event  the event
+     */
+    inline void push(const InputEvent& event) {
+        if(!this->ring.push(event)) {
+            this->nr_dropped++;
+        }
+    }
+
+    /**
+     * @brief      take the oldest event (consumer only)
+     *
+     * @param      event  receives the event
+     *
+     * @return     false when no events are pending
+     */
+    inline bool pop(InputEvent* event) {
+        return this->ring.pop(event);
+    }
+
+    /**
+     * @brief      number of events lost because the queue was full
+     */
+    inline unsigned int get_nr_dropped() const {
+        return this->nr_dropped;
+    }
+
+private:
+    InputQueue() : nr_dropped(0) {}
+
+    /* Singleton pattern; the function below are deleted */
+    InputQueue(InputQueue const&)          = delete;
+    void operator=(InputQueue const&)  = delete;
+};
+
+#endif // _INPUT_QUEUE_H
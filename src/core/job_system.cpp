@@ -0,0 +1,294 @@
+/**************************************************************************
+ *   job_system.cpp  --  This file is part of Acardov.                    *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "core/job_system.h"
+
+JobSystem::JobSystem() :
+    nr_queued(0),
+    nr_background(0),
+    flag_stop(false) {
+
+    // one deque for the threads outside of the pool and one per worker
+    const unsigned int nr_threads = std::max(2u, boost::thread::hardware_concurrency());
+    for(unsigned int i=0; i<nr_threads; i++) {
+        this->queues.emplace_back(new Queue());
+    }
+
+    for(unsigned int i=1; i<nr_threads; i++) {
+        this->workers.add_thread(new boost::thread(&JobSystem::work, this, i));
+    }
+}
+
+/**
+ * @brief       queue a task
+ *
+ * @param       task            work to perform
+ *
+ * @return      handle to the job
+ */
+JobHandle JobSystem::submit(const std::function<void()>& task) {
+    JobHandle job = std::make_shared<Job>();
+    job->task = task;
+    job->nr_dependencies = 0;
+    this->push(job);
+
+    return job;
+}
+
+/**
+ * @brief       queue a task that may only start when other jobs have finished
+ *
+ * @param       task            work to perform
+ * @param       dependencies    jobs that need to finish first
+ *
+ * @return      handle to the job
+ */
+JobHandle JobSystem::submit(const std::function<void()>& task, const std::vector<JobHandle>& dependencies) {
+    JobHandle job = std::make_shared<Job>();
+    job->task = task;
+
+    // the initial count of one keeps the job from starting while the dependencies are registered
+    for(const JobHandle& dependency: dependencies) {
+        boost::lock_guard<boost::mutex> lock(dependency->mutex);
+        if(!dependency->flag_finished) {
+            job->nr_dependencies++;
+            dependency->continuations.push_back(job);
+        }
+    }
+
+    if(--job->nr_dependencies == 0) {
+        this->push(job);
+    }
+
+    return job;
+}
+
+/**
+ * @brief       queue a long task that is only executed by the workers
+ *
+ * @param       task            work to perform
+ *
+ * @return      handle to the job
+ */
+JobHandle JobSystem::submit_background(const std::function<void()>& task) {
+    JobHandle job = std::make_shared<Job>();
+    job->task = task;
+    job->nr_dependencies = 0;
+
+    this->nr_background++;
+    {
+        boost::lock_guard<boost::mutex> lock(this->background.mutex);
+        this->background.jobs.push_back(job);
+    }
+
+    // taking the lock ensures that a worker about to sleep sees the new job
+    {
+        boost::lock_guard<boost::mutex> lock(this->sleep_mutex);
+    }
+    this->wakeup.notify_one();
+
+    return job;
+}
+
+/**
+ * @brief       wait for a job, executing other jobs in the meantime
+ *
+ * @param       job             handle to the job
+ */
+void JobSystem::wait(const JobHandle& job) {
+    const unsigned int index = current_index();
+    while(!job->flag_finished) {
+        if(!this->run_one(index)) {
+            boost::this_thread::yield();
+        }
+    }
+}
+
+/**
+ * @brief       wait for a number of jobs
+ *
+ * @param       jobs            handles to the jobs
+ */
+void JobSystem::wait(const std::vector<JobHandle>& jobs) {
+    for(const JobHandle& job: jobs) {
+        this->wait(job);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        boost::lock_guard<boost::mutex> lock(this->sleep_mutex);
+        this->flag_stop = true;
+    }
+    this->wakeup.notify_all();
+    this->workers.join_all();
+}
+
+/**
+ * @brief       place a job whose dependencies are done in the deque of the calling thread
+ */
+void JobSystem::push(const JobHandle& job) {
+    // count first, such that the counter never drops below the number of queued jobs
+    this->nr_queued++;
+
+    Queue& queue = *this->queues[current_index()];
+    {
+        boost::lock_guard<boost::mutex> lock(queue.mutex);
+        queue.jobs.push_back(job);
+    }
+
+    // taking the lock ensures that a worker about to sleep sees the new job
+    {
+        boost::lock_guard<boost::mutex> lock(this->sleep_mutex);
+    }
+    this->wakeup.notify_one();
+}
+
+/**
+ * @brief       take a job from the own deque or steal one from another
+ *
+ * @param       index           deque of the calling thread
+ *
+ * @return      the job or an empty handle when there is no work
+ */
+JobHandle JobSystem::pop(unsigned int index) {
+    if(this->nr_queued == 0) {
+        return JobHandle();
+    }
+
+    {
+        Queue& queue = *this->queues[index];
+        boost::lock_guard<boost::mutex> lock(queue.mutex);
+        if(!queue.jobs.empty()) {
+            JobHandle job = queue.jobs.back();
+            queue.jobs.pop_back();
+            this->nr_queued--;
+            return job;
+        }
+    }
+
+    // steal the oldest job of another deque
+    const unsigned int nr_queues = this->queues.size();
+    for(unsigned int i=1; i<nr_queues; i++) {
+        Queue& queue = *this->queues[(index + i) % nr_queues];
+        boost::lock_guard<boost::mutex> lock(queue.mutex);
+        if(!queue.jobs.empty()) {
+            JobHandle job = queue.jobs.front();
+            queue.jobs.pop_front();
+            this->nr_queued--;
+            return job;
+        }
+    }
+
+    return JobHandle();
+}
+
+/**
+ * @brief       execute a single job if there is one
+ *
+ * @param       index           deque of the calling thread
+ *
+ * @return      whether a job was executed
+ */
+bool JobSystem::run_one(unsigned int index) {
+    const JobHandle job = this->pop(index);
+    if(!job) {
+        return false;
+    }
+
+    this->execute(job);
+    return true;
+}
+
+/**
+ * @brief       take the oldest background job
+ *
+ * @return      the job or an empty handle when there is none
+ */
+JobHandle JobSystem::pop_background() {
+    if(this->nr_background == 0) {
+        return JobHandle();
+    }
+
+    boost::lock_guard<boost::mutex> lock(this->background.mutex);
+    if(this->background.jobs.empty()) {
+        return JobHandle();
+    }
+
+    JobHandle job = this->background.jobs.front();
+    this->background.jobs.pop_front();
+    this->nr_background--;
+    return job;
+}
+
+/**
+ * @brief       execute a job and release the jobs that depend on it
+ */
+void JobSystem::execute(const JobHandle& job) {
+    job->task();
+
+    std::vector<JobHandle> continuations;
+    {
+        boost::lock_guard<boost::mutex> lock(job->mutex);
+        job->flag_finished = true;
+        continuations.swap(job->continuations);
+    }
+
+    for(const JobHandle& continuation: continuations) {
+        if(--continuation->nr_dependencies == 0) {
+            this->push(continuation);
+        }
+    }
+}
+
+/**
+ * @brief       main loop of a worker thread
+ *
+ * @param       index           deque of the worker
+ */
+void JobSystem::work(unsigned int index) {
+    current_index() = index;
+
+    while(!this->flag_stop) {
+        if(this->run_one(index)) {
+            continue;
+        }
+
+        // background jobs only when there is nothing else to do
+        const JobHandle job = this->pop_background();
+        if(job) {
+            this->execute(job);
+            continue;
+        }
+
+        boost::unique_lock<boost::mutex> lock(this->sleep_mutex);
+        while(this->nr_queued == 0 && this->nr_background == 0 && !this->flag_stop) {
+            this->wakeup.wait(lock);
+        }
+    }
+}
+
+/**
+ * @brief       get the deque of the calling thread
+ */
+unsigned int& JobSystem::current_index() {
+    static thread_local unsigned int index = 0;
+    return index;
+}
@@ -0,0 +1,283 @@
+/**************************************************************************
+ *   job_system.h  --  This file is part of Acardov.                      *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _JOB_SYSTEM_H
+#define _JOB_SYSTEM_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <boost/thread.hpp>
+
+/**
+ * @struct Job
+ * @brief  unit of work of the job system
+ */
+struct Job {
+    std::function<void()> task;                         //!< work to perform
+    std::atomic<unsigned int> nr_dependencies;          //!< unfinished dependencies (plus one while submitting)
+    std::atomic<bool> flag_finished;                    //!< whether the task has been performed
+    boost::mutex mutex;                                 //!< guards the continuations
+    std::vector<std::shared_ptr<Job> > continuations;   //!< jobs waiting for this one
+
+    Job() : nr_dependencies(1), flag_finished(false) {}
+};
+
+typedef std::shared_ptr<Job> JobHandle;
+
+/**
+ * @class JobSystem
+ * @brief Pool of worker threads that executes jobs for the whole engine
+ *
+ * Every worker owns a deque of jobs. A worker takes new work from the back
+ * of its own deque (most recent first, which is still in cache) and, when
+ * it runs dry, steals from the front of the deques of the others. Threads
+ * that are not workers (such as the main thread) submit to a shared deque
+ * and help executing jobs while they wait for a result, so waiting on a
+ * job never blocks a core.
+ *
+ * Long jobs that nobody waits for within a frame (such as writing an
+ * autosave) are submitted as background jobs. These go to a separate deque
+ * that only the workers drain, and only when there is no other work; a
+ * thread that waits for a result never picks one up, hence such a job can
+ * never stall the main thread.
+ *
+ * A job may depend on other jobs; it is only queued once all of them have
+ * finished.
+ */
+class JobSystem {
+private:
+    /**
+     * @struct Queue
+     * @brief  deque of jobs of a single worker
+     */
+    struct Queue {
+        boost::mutex mutex;                 //!< guards the deque
+        std::deque<JobHandle> jobs;         //!< queued jobs
+    };
+
+    std::vector<std::unique_ptr<Queue> > queues;    //!< deque 0 is shared by all threads that are not workers
+    Queue background;                               //!< background jobs, only drained by the workers
+    std::atomic<unsigned int> nr_background;        //!< number of jobs in the background deque
+    boost::thread_group workers;                    //!< worker threads
+    std::atomic<unsigned int> nr_queued;            //!< number of jobs in all deques
+    std::atomic<bool> flag_stop;                    //!< whether the workers should quit
+
+    boost::mutex sleep_mutex;                       //!< guards sleeping on the condition
+    boost::condition_variable wakeup;               //!< signals newly queued jobs
+
+public:
+    /**
+     * @brief       get a reference to the job system
+     *
+     * @return      reference to the job system object (singleton pattern)
+     */
+    static JobSystem& get() {
+        static JobSystem job_system_instance;
+        return job_system_instance;
+    }
+
+    /**
+     * @brief       queue a task
+     *
+     * @param       task            work to perform
+     *
+     * @return      handle to the job
+     */
+    JobHandle submit(const std::function<void()>& task);
+
+    /**
+     * @brief       queue a task that may only start when other jobs have finished
+     *
+     * @param       task            work to perform
+     * @param       dependencies    jobs that need to finish first
+     *
+     * @return      handle to the job
+     */
+    JobHandle submit(const std::function<void()>& task, const std::vector<JobHandle>& dependencies);
+
+    /**
+     * @brief       queue a long task that is only executed by the workers
+     *
+     * Waiting threads never execute background jobs; wait for one only
+     * where stalling is acceptable (e.g. upon shutdown).
+     *
+     * @param       task            work to perform
+     *
+     * @return      handle to the job
+     */
+    JobHandle submit_background(const std::function<void()>& task);
+
+    /**
+     * @brief       wait for a job, executing other jobs in the meantime
+     *
+     * @param       job             handle to the job
+     */
+    void wait(const JobHandle& job);
+
+    /**
+     * @brief       wait for a number of jobs
+     *
+     * @param       jobs            handles to the jobs
+     */
+    void wait(const std::vector<JobHandle>& jobs);
+
+    /**
+     * @brief       call a function for consecutive chunks of a range in parallel
+     *
+     * The range is cut into chunks of grain elements (the last one may be
+     * smaller); func(chunk_begin, chunk_end) is called once for every chunk.
+     * Returns when all chunks are done.
+     *
+     * @param       begin           first index
+     * @param       end             index past the last one
+     * @param       grain           number of indices per chunk
+     * @param       func            function to call
+     */
+    template<typename Func>
+    void parallel_for(size_t begin, size_t end, size_t grain, const Func& func) {
+        if(end <= begin) {
+            return;
+        }
+
+        grain = std::max<size_t>(1, grain);
+        if(end - begin <= grain) {
+            func(begin, end);
+            return;
+        }
+
+        std::vector<JobHandle> jobs;
+        jobs.reserve((end - begin + grain - 1) / grain);
+        for(size_t first=begin; first<end; first+=grain) {
+            const size_t last = std::min(first + grain, end);
+            jobs.push_back(this->submit([&func, first, last]() {
+                func(first, last);
+            }));
+        }
+        this->wait(jobs);
+    }
+
+    /**
+     * @brief       reduce a range in parallel with a deterministic result
+     *
+     * Every chunk is mapped to a partial result by map(chunk_begin, chunk_end);
+     * the partial results are combined in the order of the chunks. As long
+     * as the grain does not change, the result is therefore bitwise the same
+     * irrespective of the number of threads or the order of execution, even
+     * for operations (such as floating point addition) that are not
+     * associative.
+     *
+     * @param       begin           first index
+     * @param       end             index past the last one
+     * @param       grain           number of indices per chunk
+     * @param       identity        initial value of the result
+     * @param       map             function giving the result of a chunk
+     * @param       combine         function combining two results
+     *
+     * @return      combined result
+     */
+    template<typename T, typename Map, typename Combine>
+    T parallel_reduce(size_t begin, size_t end, size_t grain, const T& identity, const Map& map, const Combine& combine) {
+        if(end <= begin) {
+            return identity;
+        }
+
+        grain = std::max<size_t>(1, grain);
+        std::vector<T> partials((end - begin + grain - 1) / grain, identity);
+        this->parallel_for(0, partials.size(), 1, [&](size_t first, size_t last) {
+            for(size_t c=first; c<last; c++) {
+                partials[c] = map(begin + c * grain, std::min(begin + (c + 1) * grain, end));
+            }
+        });
+
+        T result = identity;
+        for(const T& partial: partials) {
+            result = combine(result, partial);
+        }
+        return result;
+    }
+
+    /**
+     * @brief       get the number of threads that execute jobs, including the calling thread
+     */
+    inline unsigned int get_nr_threads() const {
+        return this->queues.size();
+    }
+
+    ~JobSystem();
+
+private:
+    JobSystem();
+
+    /**
+     * @brief       place a job whose dependencies are done in the deque of the calling thread
+     */
+    void push(const JobHandle& job);
+
+    /**
+     * @brief       take a job from the own deque or steal one from another
+     *
+     * @param       index           deque of the calling thread
+     *
+     * @return      the job or an empty handle when there is no work
+     */
+    JobHandle pop(unsigned int index);
+
+    /**
+     * @brief       execute a single job if there is one
+     *
+     * @param       index           deque of the calling thread
+     *
+     * @return      whether a job was executed
+     */
+    bool run_one(unsigned int index);
+
+    /**
+     * @brief       take the oldest background job
+     *
+     * @return      the job or an empty handle when there is none
+     */
+    JobHandle pop_background();
+
+    /**
+     * @brief       execute a job and release the jobs that depend on it
+     */
+    void execute(const JobHandle& job);
+
+    /**
+     * @brief       main loop of a worker thread
+     *
+     * @param       index           deque of the worker
+     */
+    void work(unsigned int index);
+
+    /**
+     * @brief       get the deque of the calling thread
+     */
+    static unsigned int& current_index();
+
+    JobSystem(JobSystem const&)          = delete;
+    void operator=(JobSystem const&)     = delete;
+};
+
+#endif //_JOB_SYSTEM_H
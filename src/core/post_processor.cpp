@@ -31,7 +31,7 @@ PostProcessor::PostProcessor() : texture_slot(POSTPROCESSOR_TEXTURE_SLOT) {
 
     this->load_mesh();
 
-    glActiveTexture(GL_TEXTURE2);
+    GLState::get().active_texture(GL_TEXTURE2);
 
     // msaa buffer
     this->create_msaa_buffer(&this->depth_msaa, &this->texture_msaa, &this->frame_buffer_msaa);
@@ -49,26 +49,26 @@ PostProcessor::PostProcessor() : texture_slot(POSTPROCESSOR_TEXTURE_SLOT) {
     const float blur_radius = 2.0f;
     this->create_shader(&this->shader_blur_h, "assets/filters/blur");
     const float width = (float)Screen::get().get_resolution_x();
-    this->shader_blur_h->set_uniform("resolution", &width);
-    this->shader_blur_h->set_uniform("radius", &blur_radius);
-    this->shader_blur_h->set_uniform("dir", &glm::vec2(1,0)[0]);
+    this->shader_blur_h->set_uniform(this->uniform_resolution, &width);
+    this->shader_blur_h->set_uniform(this->uniform_radius, &blur_radius);
+    this->shader_blur_h->set_uniform(this->uniform_dir, &glm::vec2(1,0)[0]);
 
     this->create_shader(&this->shader_blur_v, "assets/filters/blur");
     const float height = (float)Screen::get().get_resolution_y();
-    this->shader_blur_v->set_uniform("resolution", &height);
-    this->shader_blur_v->set_uniform("radius", &blur_radius);
-    this->shader_blur_v->set_uniform("dir", &glm::vec2(0,1)[0]);
+    this->shader_blur_v->set_uniform(this->uniform_resolution, &height);
+    this->shader_blur_v->set_uniform(this->uniform_radius, &blur_radius);
+    this->shader_blur_v->set_uniform(this->uniform_dir, &glm::vec2(0,1)[0]);
 
     // unbind vertex array
-    glBindVertexArray(0);
+    GLState::get().bind_vertex_array(0);
 }
 
 /**
  * @brief      bind the msaa frame buffer
  */
 void PostProcessor::bind_frame_buffer() {
-    glBindFramebuffer(GL_FRAMEBUFFER, this->frame_buffer_msaa);
-    glEnable(GL_MULTISAMPLE);
+    GLState::get().bind_framebuffer(GL_FRAMEBUFFER, this->frame_buffer_msaa);
+    GLState::get().enable(GL_MULTISAMPLE);
     GLenum status;
     if ((status = glCheckFramebufferStatus(GL_FRAMEBUFFER)) != GL_FRAMEBUFFER_COMPLETE && (Screen::get().get_resolution_x() != 0 || Screen::get().get_resolution_y() != 0)) {
         std::cerr << "glCheckFramebufferStatus: error " << status << std::endl;
@@ -88,7 +88,7 @@ void PostProcessor::bind_frame_buffer() {
  * @brief      unbind all frame buffers
  */
 void PostProcessor::unbind_frame_buffer() {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::get().bind_framebuffer(GL_FRAMEBUFFER, 0);
 }
 
 /**
@@ -115,11 +115,11 @@ void PostProcessor::window_reshape() {
 
     this->shader_blur_h->link_shader();
     const float width = Screen::get().get_resolution_x() != 0 ? (float)Screen::get().get_resolution_x() : 1.0f;
-    this->shader_blur_h->set_uniform("resolution", &width);
+    this->shader_blur_h->set_uniform(this->uniform_resolution, &width);
 
-    this->shader_blur_h->link_shader();
+    this->shader_blur_v->link_shader();
 	const float height = Screen::get().get_resolution_y() != 0 ? (float)Screen::get().get_resolution_y() : 1.0f;
-    this->shader_blur_v->set_uniform("resolution", &height);
+    this->shader_blur_v->set_uniform(this->uniform_resolution, &height);
 }
 
 /**
@@ -146,14 +146,14 @@ PostProcessor::~PostProcessor() {
  * @brief      blit the content of the msaa fbo to the primary fbo
  */
 void PostProcessor::resample_buffer() {
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, this->frame_buffer_msaa);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->frame_buffer_p);
+    GLState::get().bind_framebuffer(GL_READ_FRAMEBUFFER, this->frame_buffer_msaa);
+    GLState::get().bind_framebuffer(GL_DRAW_FRAMEBUFFER, this->frame_buffer_p);
 
     const unsigned int width = Screen::get().get_resolution_x() != 0 ? Screen::get().get_resolution_x() : 1;
     const unsigned int height = Screen::get().get_resolution_y() != 0 ? Screen::get().get_resolution_y() : 1;
 
     glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::get().bind_framebuffer(GL_FRAMEBUFFER, 0);
 }
 
 /**
@@ -176,13 +176,13 @@ void PostProcessor::apply_filters() {
  */
 void PostProcessor::pass(const std::unique_ptr<Shader>& shader) {
     //set buffer (draw to passive buffer)
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->frame_buffer_passive);
+    GLState::get().bind_framebuffer(GL_DRAW_FRAMEBUFFER, this->frame_buffer_passive);
 
     // perform draw
     this->render(shader);
 
     // unset buffer
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    GLState::get().bind_framebuffer(GL_DRAW_FRAMEBUFFER, 0);
 
     // swap buffers
     this->swap_active_buffer();
@@ -229,8 +229,8 @@ void PostProcessor::render(const std::unique_ptr<Shader>& shader) {
     glClearColor(0.0, 0.0, 0.0, 1.0);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, this->texture_active);
+    GLState::get().active_texture(GL_TEXTURE2);
+    GLState::get().bind_texture(GL_TEXTURE_2D, this->texture_active);
 
     shader->link_shader();
 
@@ -249,15 +249,15 @@ void PostProcessor::render(const std::unique_ptr<Shader>& shader) {
     const glm::mat4 mvp = glm::scale(glm::vec3(sx, sy, 1.0f));
 
     // set shader uniforms
-    shader->set_uniform("text", &this->texture_slot); // set texture id
-    shader->set_uniform("mvp", &mvp[0][0]);
+    shader->set_uniform(this->uniform_text, &this->texture_slot); // set texture id
+    shader->set_uniform(this->uniform_mvp, &mvp[0][0]);
 
-    glBindVertexArray(this->vao);
+    GLState::get().bind_vertex_array(this->vao);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    GLState::get().bind_vertex_array(0);
 
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glActiveTexture(GL_TEXTURE2);
+    GLState::get().bind_texture(GL_TEXTURE_2D, 0);
+    GLState::get().active_texture(GL_TEXTURE2);
 }
 
 /**
@@ -272,21 +272,21 @@ void PostProcessor::create_msaa_buffer(GLuint* render_buffer, GLuint* texture, G
     glRenderbufferStorageMultisample(GL_RENDERBUFFER, this->msaa, GL_DEPTH24_STENCIL8, width, height);
     glBindRenderbuffer(GL_RENDERBUFFER, 0);
 
-    glActiveTexture(GL_TEXTURE2);
+    GLState::get().active_texture(GL_TEXTURE2);
     glGenTextures(1, texture);
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, *texture);
+    GLState::get().bind_texture(GL_TEXTURE_2D_MULTISAMPLE, *texture);
     glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, this->msaa, GL_RGBA, width, height, GL_TRUE);
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+    GLState::get().bind_texture(GL_TEXTURE_2D_MULTISAMPLE, 0);
 
     glGenFramebuffers(1, frame_buffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, *frame_buffer);
+    GLState::get().bind_framebuffer(GL_FRAMEBUFFER, *frame_buffer);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, *texture, 0);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, *render_buffer);
     GLenum status;
     if ((status = glCheckFramebufferStatus(GL_FRAMEBUFFER)) != GL_FRAMEBUFFER_COMPLETE) {
         std::cerr << "glCheckFramebufferStatus: error " << status << std::endl;
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::get().bind_framebuffer(GL_FRAMEBUFFER, 0);
 }
 
 /**
@@ -301,9 +301,9 @@ void PostProcessor::create_buffer(GLuint* render_buffer, GLuint* texture, GLuint
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, width, height);
     glBindRenderbuffer(GL_RENDERBUFFER, 0);
 
-    glActiveTexture(GL_TEXTURE2);
+    GLState::get().active_texture(GL_TEXTURE2);
     glGenTextures(1, texture);
-    glBindTexture(GL_TEXTURE_2D, *texture);
+    GLState::get().bind_texture(GL_TEXTURE_2D, *texture);
 
     // set minmag filters (GL_NEAREST is faster, GL_LINEAR is higher quality)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -312,10 +312,10 @@ void PostProcessor::create_buffer(GLuint* render_buffer, GLuint* texture, GLuint
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::get().bind_texture(GL_TEXTURE_2D, 0);
 
     glGenFramebuffers(1, frame_buffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, *frame_buffer);
+    GLState::get().bind_framebuffer(GL_FRAMEBUFFER, *frame_buffer);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, *texture, 0);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, *render_buffer);
 
@@ -323,7 +323,7 @@ void PostProcessor::create_buffer(GLuint* render_buffer, GLuint* texture, GLuint
     if ((status = glCheckFramebufferStatus(GL_FRAMEBUFFER)) != GL_FRAMEBUFFER_COMPLETE) {
         std::cerr << "glCheckFramebufferStatus: error " << status << std::endl;
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::get().bind_framebuffer(GL_FRAMEBUFFER, 0);
 }
 
 /**
@@ -331,10 +331,10 @@ void PostProcessor::create_buffer(GLuint* render_buffer, GLuint* texture, GLuint
  */
 void PostProcessor::set_msaa_buffer(GLuint texture, GLuint frame_buffer) {
     // resize regular buffer
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, texture);
+    GLState::get().active_texture(GL_TEXTURE2);
+    GLState::get().bind_texture(GL_TEXTURE_2D_MULTISAMPLE, texture);
     glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, this->msaa, GL_RGBA, Screen::get().get_resolution_x(), Screen::get().get_resolution_y(), GL_TRUE);
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+    GLState::get().bind_texture(GL_TEXTURE_2D_MULTISAMPLE, 0);
 
     glBindRenderbuffer(GL_RENDERBUFFER, frame_buffer);
     glRenderbufferStorageMultisample(GL_RENDERBUFFER, this->msaa, GL_DEPTH24_STENCIL8, Screen::get().get_resolution_x(), Screen::get().get_resolution_y());
@@ -348,10 +348,10 @@ void PostProcessor::set_buffer(GLuint texture, GLuint frame_buffer) {
     const unsigned int width = Screen::get().get_resolution_x();
     const unsigned int height = Screen::get().get_resolution_y();
 
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    GLState::get().active_texture(GL_TEXTURE2);
+    GLState::get().bind_texture(GL_TEXTURE_2D, texture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::get().bind_texture(GL_TEXTURE_2D, 0);
 
     glBindRenderbuffer(GL_RENDERBUFFER, frame_buffer);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, Screen::get().get_resolution_x(), Screen::get().get_resolution_y());
@@ -364,28 +364,28 @@ void PostProcessor::set_buffer(GLuint texture, GLuint frame_buffer) {
 void PostProcessor::create_shader(std::unique_ptr<Shader>* shader, const std::string& filename) {
     *shader = std::unique_ptr<Shader>(new Shader(filename));
     shader->get()->add_attribute(ShaderAttribute::POSITION, "position");
-    shader->get()->add_uniform(ShaderUniform::TEXTURE, "text", 1);
-    shader->get()->add_uniform(ShaderUniform::MAT4, "mvp", 1);
+    this->uniform_text = shader->get()->add_uniform<ShaderUniform::TEXTURE>("text", 1);
+    this->uniform_mvp = shader->get()->add_uniform<ShaderUniform::MAT4>("mvp", 1);
 
     if(filename.compare("assets/filters/blur") == 0) {
-        shader->get()->add_uniform(ShaderUniform::FLOAT, "resolution", 1);
-        shader->get()->add_uniform(ShaderUniform::FLOAT, "radius", 1);
-        shader->get()->add_uniform(ShaderUniform::VEC2, "dir", 1);
+        this->uniform_resolution = shader->get()->add_uniform<ShaderUniform::FLOAT>("resolution", 1);
+        this->uniform_radius = shader->get()->add_uniform<ShaderUniform::FLOAT>("radius", 1);
+        this->uniform_dir = shader->get()->add_uniform<ShaderUniform::VEC2>("dir", 1);
     }
 
-    glBindVertexArray(this->vao);
+    GLState::get().bind_vertex_array(this->vao);
     shader->get()->bind_uniforms_and_attributes();
-    glBindVertexArray(0);
+    GLState::get().bind_vertex_array(0);
 }
 
 void PostProcessor::load_mesh() {
-    std::vector<glm::vec3> positions;
+    std::vector<VertexP> vertices(4);
     std::vector<unsigned int> indices;
 
-    positions.push_back(glm::vec3(-1, -1, 0));
-    positions.push_back(glm::vec3( 1, -1, 0));
-    positions.push_back(glm::vec3( 1,  1, 0));
-    positions.push_back(glm::vec3(-1,  1, 0));
+    vertices[0].position = glm::vec3(-1, -1, 0);
+    vertices[1].position = glm::vec3( 1, -1, 0);
+    vertices[2].position = glm::vec3( 1,  1, 0);
+    vertices[3].position = glm::vec3(-1,  1, 0);
     indices.push_back(0);
     indices.push_back(2);
     indices.push_back(3);
@@ -393,17 +393,5 @@ void PostProcessor::load_mesh() {
     indices.push_back(1);
     indices.push_back(2);
 
-    glGenVertexArrays(1, &this->vao);
-    glBindVertexArray(this->vao);
-    glGenBuffers(2, this->vbo);
-
-    glBindBuffer(GL_ARRAY_BUFFER, this->vbo[0]);
-    glBufferData(GL_ARRAY_BUFFER, positions.size() * 3 * sizeof(float), &positions[0][0], GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->vbo[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-
-    glBindVertexArray(0);
+    LayoutP::load_indexed(&this->vao, this->vbo, vertices, indices);
 }
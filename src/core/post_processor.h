@@ -28,6 +28,7 @@
 
 #include "screen.h"
 #include "shader.h"
+#include "vertex_layout.h"
 
 #define POSTPROCESSOR_TEXTURE_SLOT 2
 
@@ -66,6 +67,13 @@ private:
     std::unique_ptr<Shader> shader_blur_h;            //!< shader that performs horizontal blur
     std::unique_ptr<Shader> shader_blur_v;            //!< shader that performs vertical blur
 
+    // all filters add their uniforms in the same order and hence share the handles
+    UniformHandle<ShaderUniform::TEXTURE> uniform_text;       //!< texture to filter
+    UniformHandle<ShaderUniform::MAT4> uniform_mvp;           //!< mvp of the screen quad
+    UniformHandle<ShaderUniform::FLOAT> uniform_resolution;   //!< resolution along the blur direction
+    UniformHandle<ShaderUniform::FLOAT> uniform_radius;       //!< blur radius
+    UniformHandle<ShaderUniform::VEC2> uniform_dir;           //!< blur direction
+
     unsigned int filter_flags;              //!< keeps track of what filters need to be applied
 
     GLuint vao;
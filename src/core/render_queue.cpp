@@ -0,0 +1,135 @@
+/**************************************************************************
+ *   render_queue.cpp  --  This file is part of Acardov.                  *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+#include "core/render_queue.h"
+
+RenderQueue::RenderQueue() :
+    nr_state_changes(0),
+    nr_state_changes_saved(0),
+    nr_draws(0) {}
+
+/**
+ * @brief       queue a draw
+ *
+ * @param       pass    render pass (see enum above)
+ * @param       depth   depth (opaque) or layer (blended); only the lower 24 bits are used
+ * @param       item    the draw
+ */
+void RenderQueue::submit(unsigned int pass, uint32_t depth, const DrawItem& item) {
+    this->keys.push_back(std::make_pair(make_key(pass, depth, item), (uint32_t)this->items.size()));
+    this->items.push_back(item);
+}
+
+/**
+ * @brief       sort the queued draws, execute them and empty the queue
+ */
+void RenderQueue::flush() {
+    this->nr_state_changes = 0;
+    this->nr_state_changes_saved = 0;
+    this->nr_draws = this->items.size();
+
+    if(this->items.empty()) {
+        return;
+    }
+
+    // binds the submission order would have required
+    unsigned int nr_state_changes_unsorted = (this->items[0].texture != 0) ? 4 : 2;
+    for(unsigned int i=1; i<this->items.size(); i++) {
+        nr_state_changes_unsorted += count_state_changes(this->items[i-1], this->items[i]);
+    }
+
+    // the position is part of the pair, hence equal keys keep their submission order
+    std::sort(this->keys.begin(), this->keys.end());
+
+    // the binds always go through GLState, which knows the actual GL state
+    // (other code changes e.g. the active texture unit in between flushes)
+    // and drops the redundant ones; the binds that reach the driver are counted
+    GLState& state = GLState::get();
+    for(const auto& key: this->keys) {
+        const DrawItem& item = this->items[key.second];
+
+        const unsigned long int nr_calls = state.get_nr_calls() - state.get_nr_calls_eliminated();
+
+        state.use_program(item.program);
+        if(item.texture != 0) {
+            state.active_texture(GL_TEXTURE0 + item.texture_unit);
+            state.bind_texture(GL_TEXTURE_2D, item.texture);
+        }
+        state.bind_vertex_array(item.vao);
+
+        this->nr_state_changes += (state.get_nr_calls() - state.get_nr_calls_eliminated()) - nr_calls;
+
+        if(item.prepare != NULL) {
+            item.prepare(item);
+        }
+
+        if(item.nr_instances > 0) {
+            glDrawElementsInstancedBaseVertex(item.mode, item.count, GL_UNSIGNED_INT, item.offset, item.nr_instances, item.base_vertex);
+        } else {
+            glDrawElementsBaseVertex(item.mode, item.count, GL_UNSIGNED_INT, item.offset, item.base_vertex);
+        }
+    }
+
+    // GLState drops redundant binds, hence the program and textures are left
+    // bound; only the vertex array is released, such that later buffer
+    // uploads cannot alter it
+    state.bind_vertex_array(0);
+
+    if(nr_state_changes_unsorted > this->nr_state_changes) {
+        this->nr_state_changes_saved = nr_state_changes_unsorted - this->nr_state_changes;
+    }
+
+    this->items.clear();
+    this->keys.clear();
+}
+
+/**
+ * @brief       build the sort key of a draw
+ *
+ * @param       pass    render pass
+ * @param       depth   depth or layer (lower 24 bits)
+ * @param       item    the draw
+ *
+ * @return      sort key
+ */
+uint64_t RenderQueue::make_key(unsigned int pass, uint32_t depth, const DrawItem& item) {
+    const uint64_t p = (uint64_t)(pass & 0xF);
+    const uint64_t d = (uint64_t)(depth & 0xFFFFFF);
+    const uint64_t state = ((uint64_t)(item.program & 0xFFF) << 24) |
+                           ((uint64_t)(item.texture & 0xFFF) << 12) |
+                            (uint64_t)(item.vao & 0xFFF);
+
+    if(pass == PASS_OPAQUE) {
+        return (p << 60) | (state << 24) | d;
+    } else {
+        return (p << 60) | (d << 36) | state;
+    }
+}
+
+/**
+ * @brief       count the binds required to go from one draw to the next
+ */
+unsigned int RenderQueue::count_state_changes(const DrawItem& previous, const DrawItem& next) {
+    unsigned int changes = 0;
+    changes += (previous.program != next.program) ? 1 : 0;
+    changes += (next.texture != 0 && previous.texture_unit != next.texture_unit) ? 1 : 0;
+    changes += (next.texture != 0 && (previous.texture != next.texture || previous.texture_unit != next.texture_unit)) ? 1 : 0;
+    changes += (previous.vao != next.vao) ? 1 : 0;
+    return changes;
+}
@@ -0,0 +1,140 @@
+/**************************************************************************
+ *   render_queue.h  --  This file is part of Acardov.                    *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+#ifndef _RENDER_QUEUE_H
+#define _RENDER_QUEUE_H
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <GL/glew.h>
+
+#include "core/gl_state.h"
+
+/**
+ * @struct DrawItem
+ * @brief  a single draw call together with the state it needs
+ */
+struct DrawItem {
+    GLuint program;                 //!< shader program
+    unsigned int texture_unit;      //!< texture unit (0 for GL_TEXTURE0, 1 for GL_TEXTURE1, ...)
+    GLuint texture;                 //!< 2D texture bound to the unit (0 for none)
+    GLuint vao;                     //!< vertex array object
+
+    GLenum mode;                    //!< primitive type
+    GLsizei count;                  //!< number of indices
+    const GLvoid* offset;           //!< byte offset in the element buffer
+    GLint base_vertex;              //!< value added to every index
+    GLsizei nr_instances;           //!< number of instances (0 for a regular draw)
+
+    void (*prepare)(const DrawItem& item);  //!< uploads the per-object uniforms (NULL for none)
+    const void* owner;                      //!< object that submitted the item (for prepare)
+    float data[8];                          //!< per-object data (for prepare)
+};
+
+/**
+ * @class RenderQueue
+ * @brief Collects the draws of a frame and submits them sorted on state
+ *
+ * Every draw item gets a 64-bit sort key composed of the pass, program,
+ * texture, vertex array and depth. After sorting, items sharing a program,
+ * texture or vertex array are adjacent, hence these only need to be bound
+ * once per group rather than once per draw.
+ *
+ * Opaque items are keyed as pass | program | texture | vao | depth, so that
+ * the state changes as little as possible. Blended items have to be drawn in
+ * order and are keyed as pass | depth | program | texture | vao, the depth
+ * being the layer in which the item is to be drawn. Items with equal keys
+ * are drawn in the order in which they were submitted.
+ *
+ * The names of the GL objects are truncated to 12 bits in the key; a
+ * collision only costs a state change, it never yields a wrong draw.
+ */
+class RenderQueue {
+public:
+    enum {
+        PASS_OPAQUE,            //!< depth tested, no blending needed
+        PASS_TRANSPARENT,       //!< blended on top of the opaque geometry
+        PASS_GUI,               //!< screen space overlay
+
+        NR_PASSES
+    };
+
+private:
+    std::vector<DrawItem> items;                            //!< items of the current frame
+    std::vector<std::pair<uint64_t, uint32_t> > keys;       //!< sort key and position per item
+
+    unsigned int nr_state_changes;          //!< binds that reached the driver in the last flush
+    unsigned int nr_state_changes_saved;    //!< binds avoided compared to submission order
+    unsigned int nr_draws;                  //!< draws in the last flush
+
+public:
+    /**
+     * @fn          get
+     *
+     * @brief       get a reference to the render queue
+     *
+     * @return      reference to the render queue object (singleton pattern)
+     */
+    static RenderQueue& get() {
+        static RenderQueue render_queue_instance;
+        return render_queue_instance;
+    }
+
+    /**
+     * @brief       queue a draw
+     *
+     * @param       pass    render pass (see enum above)
+     * @param       depth   depth (opaque) or layer (blended); only the lower 24 bits are used
+     * @param       item    the draw
+     */
+    void submit(unsigned int pass, uint32_t depth, const DrawItem& item);
+
+    /**
+     * @brief       sort the queued draws, execute them and empty the queue
+     *
+     * Afterwards no vertex array is bound.
+     */
+    void flush();
+
+    inline unsigned int get_nr_state_changes() const {
+        return this->nr_state_changes;
+    }
+
+    inline unsigned int get_nr_state_changes_saved() const {
+        return this->nr_state_changes_saved;
+    }
+
+    inline unsigned int get_nr_draws() const {
+        return this->nr_draws;
+    }
+
+private:
+    RenderQueue();
+
+    static uint64_t make_key(unsigned int pass, uint32_t depth, const DrawItem& item);
+
+    static unsigned int count_state_changes(const DrawItem& previous, const DrawItem& next);
+
+    RenderQueue(RenderQueue const&)          = delete;
+    void operator=(RenderQueue const&)  = delete;
+};
+
+#endif //_RENDER_QUEUE_H
@@ -19,6 +19,7 @@
  **************************************************************************/
 
 #include "shader.h"
+#include "core/frame_data.h"
 
 // create an empty shader
 static GLuint create_shader(const std::string &text, GLenum shader_type);
@@ -42,6 +43,7 @@ ShaderUniform::ShaderUniform(unsigned int _type, const std::string& _name, unsig
     this->type = _type;
     this->name = _name;
     this->size = _size;
+    this->uniform_id = -1;
 }
 
 /**
@@ -78,10 +80,6 @@ Shader::Shader(const std::string& _filename) {
     this->texture_id = 0;
 }
 
-void Shader::add_uniform(unsigned int type, const std::string& name, unsigned int size) {
-    this->shader_uniforms.emplace(name, ShaderUniform(type, name, size));
-}
-
 void Shader::add_attribute(unsigned int type, const std::string& name) {
     this->shader_attributes.push_back(ShaderAttribute(type, name));
 }
@@ -99,65 +97,39 @@ void Shader::bind_uniforms_and_attributes() {
     glValidateProgram(this->m_program);
     check_shader_error(m_program, GL_VALIDATE_STATUS, true, "Error in \"" + this->filename + "\" : Program validation failed: ");
 
-    glUseProgram(this->m_program);
-
-    this->flag_loaded = true;
-}
-
-void Shader::set_uniform(const std::string& name, const void* val) {
-    // get uniform location in program
-    const GLint id = glGetUniformLocation(this->m_program, name.c_str());
-    if(id == -1) {
-        std::cerr << "Variable \"" << name << "\" does not correspond with a known uniform in this program." << std::endl;
-        exit(-1);
+    // resolve the locations of the uniforms once; the setters use them directly
+    for(unsigned int i=0; i<this->shader_uniforms.size(); i++) {
+        const GLint id = glGetUniformLocation(this->m_program, this->shader_uniforms[i].get_name().c_str());
+        if(id == -1) {
+            std::cerr << "Variable \"" << this->shader_uniforms[i].get_name() << "\" does not correspond with a known uniform in this program." << std::endl;
+        }
+        this->shader_uniforms[i].set_id(id);
     }
 
-    const ShaderUniform& uni = this->get_uniform(name);
-
-    // get uniform load function based on type
-    switch(uni.get_type()) {
-        case ShaderUniform::MAT4:
-            glUniformMatrix4fv(id, uni.get_size(), GL_FALSE, (const GLfloat*)val);
-        break;
-        case ShaderUniform::MAT3:
-            glUniformMatrix3fv(id, uni.get_size(), GL_FALSE, (const GLfloat*)val);
-        break;
-        case ShaderUniform::VEC4:
-            glUniform4fv(id, uni.get_size(), (const GLfloat*)val);
-        break;
-        case ShaderUniform::VEC3:
-            glUniform3fv(id, uni.get_size(), (const GLfloat*)val);
-        break;
-        case ShaderUniform::VEC2:
-            glUniform2fv(id, uni.get_size(), (const GLfloat*)val);
-        break;
-        case  ShaderUniform::TEXTURE:
-            glUniform1i(id, *(const int*)(val));
-        break;
-        case  ShaderUniform::FLOAT:
-            glUniform1f(id, *(const float*)(val));
-        break;
-        case  ShaderUniform::FRAME_MATRIX:
-            glUniformMatrix4fv(id, uni.get_size(), GL_FALSE, (const GLfloat*)val);
-        break;
-        case  ShaderUniform::OFFSET_MATRIX:
-            glUniformMatrix4fv(id, uni.get_size(), GL_FALSE, (const GLfloat*)val);
-        break;
-        default:
-            // do nothing
-        break;
+    // attach the per-frame uniform block, when the program uses it
+    const GLuint block_index = glGetUniformBlockIndex(this->m_program, FrameData::BLOCK_NAME);
+    if(block_index != GL_INVALID_INDEX) {
+        glUniformBlockBinding(this->m_program, block_index, FrameData::BINDING_POINT);
     }
-}
 
-const ShaderUniform& Shader::get_uniform(const std::string& name) const {
-    auto got = this->shader_uniforms.find(name);
+    GLState::get().use_program(this->m_program);
 
-    if(got == this->shader_uniforms.end()) {
-        std::cerr << "Invalid uniform name: " << name << std::endl;
-        exit(-1);
-    } else {
-        return got->second;
+    this->flag_loaded = true;
+}
+
+unsigned int Shader::find_uniform(const std::string& name, unsigned int type) const {
+    for(unsigned int i=0; i<this->shader_uniforms.size(); i++) {
+        if(this->shader_uniforms[i].get_name() == name) {
+            if(this->shader_uniforms[i].get_type() != type) {
+                std::cerr << "Uniform \"" << name << "\" is requested with a different type than it was added with." << std::endl;
+                exit(-1);
+            }
+            return i;
+        }
     }
+
+    std::cerr << "Invalid uniform name: " << name << std::endl;
+    exit(-1);
 }
 
 /*
@@ -25,11 +25,11 @@
 #include <fstream>
 #include <iostream>
 #include <vector>
-#include <unordered_map>
 #include <GL/glew.h>
 
 #include "core/asset_manager.h"
 #include "core/camera.h"
+#include "core/gl_state.h"
 
 /**
  * @class ShaderUniform class
@@ -85,11 +85,11 @@ public:
         return this->size;
     }
 
-    inline void set_id(GLuint id) {
+    inline void set_id(GLint id) {
         this->uniform_id = id;
     }
 
-    inline unsigned int get_id() const {
+    inline GLint get_id() const {
         return this->uniform_id;
     }
 
@@ -112,7 +112,97 @@ private:
     unsigned int type;                           //<! type of the uniform
     std::string name;                            //<! name of the uniform
     unsigned int size;                           //<! size of the uniform
-    GLuint uniform_id;                           //<! id of the uniform
+    GLint uniform_id;                            //<! location of the uniform in the program
+};
+
+/**
+ * @struct UniformHandle
+ * @brief  Handle to a uniform of a shader, typed on the kind of uniform
+ *
+ * The handle is the position of the uniform in the order in which the
+ * uniforms were added to the shader, hence shaders that add the same
+ * uniforms in the same order share their handles.
+ */
+template <unsigned int T>
+struct UniformHandle {
+    unsigned int index;     //!< position of the uniform in the shader
+};
+
+/**
+ * @struct UniformSetter
+ * @brief  Uploads the value of a uniform; specialised per kind of uniform
+ */
+template <unsigned int T>
+struct UniformSetter;
+
+template <>
+struct UniformSetter<ShaderUniform::MAT4> {
+    static inline void set(GLint id, GLsizei size, const void* val) {
+        glUniformMatrix4fv(id, size, GL_FALSE, (const GLfloat*)val);
+    }
+};
+
+template <>
+struct UniformSetter<ShaderUniform::MAT3> {
+    static inline void set(GLint id, GLsizei size, const void* val) {
+        glUniformMatrix3fv(id, size, GL_FALSE, (const GLfloat*)val);
+    }
+};
+
+template <>
+struct UniformSetter<ShaderUniform::VEC4> {
+    static inline void set(GLint id, GLsizei size, const void* val) {
+        glUniform4fv(id, size, (const GLfloat*)val);
+    }
+};
+
+template <>
+struct UniformSetter<ShaderUniform::VEC3> {
+    static inline void set(GLint id, GLsizei size, const void* val) {
+        glUniform3fv(id, size, (const GLfloat*)val);
+    }
+};
+
+template <>
+struct UniformSetter<ShaderUniform::VEC2> {
+    static inline void set(GLint id, GLsizei size, const void* val) {
+        glUniform2fv(id, size, (const GLfloat*)val);
+    }
+};
+
+template <>
+struct UniformSetter<ShaderUniform::TEXTURE> {
+    static inline void set(GLint id, GLsizei size, const void* val) {
+        glUniform1i(id, *(const int*)(val));
+    }
+};
+
+template <>
+struct UniformSetter<ShaderUniform::UINT> {
+    static inline void set(GLint id, GLsizei size, const void* val) {
+        glUniform1uiv(id, size, (const GLuint*)val);
+    }
+};
+
+template <>
+struct UniformSetter<ShaderUniform::FLOAT> {
+    static inline void set(GLint id, GLsizei size, const void* val) {
+        glUniform1f(id, *(const float*)(val));
+    }
+};
+
+template <>
+struct UniformSetter<ShaderUniform::FRAME_MATRIX> {
+    static inline void set(GLint id, GLsizei size, const void* val) {
+        glUniformMatrix4fv(id, size, GL_FALSE, (const GLfloat*)val);
+    }
+};
+
+template <>
+struct UniformSetter<ShaderUniform::OFFSET_MATRIX> {
+    static inline void set(GLint id, GLsizei size, const void* val) {
+        glUniformMatrix4fv(id, size, GL_FALSE, (const GLfloat*)val);
+    }
 };
 
 /**
@@ -137,6 +227,7 @@ public:
         COLOR,
         TEXTURE_COORDINATE,
         WEIGHT,
+        MATRIX,         //!< mat4 attribute, occupies four consecutive locations
 
         NUM_ATTR_TYPES
     };
@@ -175,10 +266,7 @@ private:
 
     std::vector<ShaderAttribute> shader_attributes; //!< vector holding shader attributes
 
-    std::unordered_map<std::string, ShaderUniform> shader_uniforms; //!< unordered map holding the uniforms
-
-    //std::vector<ShaderUniform> shader_uniforms;     //!< vector holding shader uniforms
-    //std::vector<GLuint> m_uniforms;                 //!< reference array to the uniforms
+    std::vector<ShaderUniform> shader_uniforms;     //!< vector holding shader uniforms (indexed by handle)
 
     bool flag_loaded;                               //!< flag whether this shader is loaded
     GLuint texture_id;                              //!< id of the texture
@@ -187,13 +275,57 @@ private:
 public:
     Shader(const std::string& _filename);
 
-    void add_uniform(unsigned int type, const std::string& name, unsigned int size);
+    /**
+     * @brief       add a uniform to the shader
+     *
+     * The location of the uniform is resolved when the program is linked
+     * in bind_uniforms_and_attributes.
+     *
+     * @param       name of the uniform
+     * @param       number of elements of the uniform
+     *
+     * @return      handle to the uniform
+     */
+    template <unsigned int T>
+    UniformHandle<T> add_uniform(const std::string& name, unsigned int size) {
+        UniformHandle<T> handle;
+        handle.index = this->shader_uniforms.size();
+        this->shader_uniforms.push_back(ShaderUniform(T, name, size));
+        return handle;
+    }
+
+    /**
+     * @brief       look up the handle of a uniform that was added before
+     *
+     * Intended for set-up code; store the handle rather than looking it up
+     * for every draw.
+     *
+     * @param       name of the uniform
+     *
+     * @return      handle to the uniform
+     */
+    template <unsigned int T>
+    UniformHandle<T> get_uniform_handle(const std::string& name) const {
+        UniformHandle<T> handle;
+        handle.index = this->find_uniform(name, T);
+        return handle;
+    }
 
     void add_attribute(unsigned int type, const std::string& name);
 
     void bind_uniforms_and_attributes();
 
-    void set_uniform(const std::string& name, const void* val);
+    /**
+     * @brief       set the value of a uniform of the active program
+     *
+     * @param       handle to the uniform
+     * @param       pointer to the value
+     */
+    template <unsigned int T>
+    inline void set_uniform(UniformHandle<T> handle, const void* val) const {
+        const ShaderUniform& uniform = this->shader_uniforms[handle.index];
+        UniformSetter<T>::set(uniform.get_id(), uniform.get_size(), val);
+    }
 
     inline long unsigned int get_nr_attributes() const {
         return this->shader_attributes.size();
@@ -203,12 +335,16 @@ public:
         return this->shader_uniforms.size();
     }
 
+    inline GLuint get_program() const {
+        return this->m_program;
+    }
+
     inline void link_shader() {
-        glUseProgram(this->m_program);
+        GLState::get().use_program(this->m_program);
     }
 
     inline void unlink_shader() {
-        glUseProgram(0);
+        GLState::get().use_program(0);
     }
 
     inline bool is_loaded() const {
@@ -218,7 +354,7 @@ public:
     virtual ~Shader();
 
 private:
-    const ShaderUniform& get_uniform(const std::string& name) const;
+    unsigned int find_uniform(const std::string& name, unsigned int type) const;
 };
 
 #endif //_SHADER_H
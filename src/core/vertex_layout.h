@@ -0,0 +1,255 @@
+/**************************************************************************
+ *   vertex_layout.h  --  This file is part of Acardov.                   *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+#ifndef _VERTEX_LAYOUT_H
+#define _VERTEX_LAYOUT_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
+#include <GL/glew.h>
+
+#include "core/gl_state.h"
+
+/*
+ * Vertex layouts
+ *
+ * A vertex layout ties a plain vertex struct to the way its members are fed
+ * to the vertex shader. The attributes (location, format and offset) are
+ * template arguments, hence the attribute setup of a vertex array is
+ * generated at compile time from the struct and cannot get out of sync with
+ * it. All attributes of a layout live interleaved in a single buffer.
+ *
+ * Normals are stored as signed normalized 10-10-10-2 words and colors as
+ * unsigned normalized bytes; use pack_normal and pack_color to fill them.
+ */
+
+/**
+ * @struct AttributeFormat
+ * @brief  data format of a vertex attribute
+ *
+ * Formats that span more than one location (matrices) have one float
+ * column of nr_components per location.
+ */
+template<GLint Components, GLenum Type, GLboolean Normalized, unsigned int Locations = 1>
+struct AttributeFormat {
+    static const GLint nr_components = Components;
+    static const GLenum type = Type;
+    static const GLboolean normalized = Normalized;
+    static const unsigned int nr_locations = Locations;
+};
+
+typedef AttributeFormat<2, GL_FLOAT, GL_FALSE> Float2;
+typedef AttributeFormat<3, GL_FLOAT, GL_FALSE> Float3;
+typedef AttributeFormat<4, GL_FLOAT, GL_FALSE, 4> Float4x4;
+typedef AttributeFormat<4, GL_INT_2_10_10_10_REV, GL_TRUE> PackedNormal;
+typedef AttributeFormat<4, GL_UNSIGNED_BYTE, GL_TRUE> PackedColor;
+
+/**
+ * @struct VertexAttribute
+ * @brief  a single attribute of a vertex layout
+ */
+template<GLuint Location, typename Format, size_t Offset>
+struct VertexAttribute {
+    /**
+     * @brief       point the attribute at the bound array buffer
+     *
+     * @param       stride      size of a vertex in bytes
+     * @param       divisor     0 for per-vertex data, 1 for per-instance data
+     */
+    static void enable(GLsizei stride, GLuint divisor) {
+        for(unsigned int i=0; i<Format::nr_locations; i++) {
+            glEnableVertexAttribArray(Location + i);
+            glVertexAttribPointer(Location + i, Format::nr_components, Format::type, Format::normalized, stride,
+                                  (const GLvoid*)(Offset + i * Format::nr_components * sizeof(GLfloat)));
+            glVertexAttribDivisor(Location + i, divisor);
+        }
+    }
+};
+
+/**
+ * @struct VertexLayout
+ * @brief  interleaved vertex struct together with its attributes
+ */
+template<typename Vertex, typename... Attributes>
+struct VertexLayout {
+    typedef Vertex vertex_type;
+
+    static_assert(std::is_standard_layout<Vertex>::value, "vertex must be a standard layout type");
+    static_assert(sizeof(Vertex) % 4 == 0, "vertex size must be a multiple of four bytes");
+
+    /**
+     * @brief       set up the attributes of the bound vertex array for the bound array buffer
+     *
+     * @param       divisor     0 for per-vertex data, 1 for per-instance data
+     */
+    static void set_attributes(GLuint divisor = 0) {
+        const int expand[] = {0, (Attributes::enable(sizeof(Vertex), divisor), 0)...};
+        (void)expand;
+    }
+
+    /**
+     * @brief       fill a buffer with vertices and attach it to the bound vertex array
+     *
+     * @param       vbo         vertex buffer
+     * @param       vertices    vertices
+     * @param       usage       usage hint of the buffer
+     */
+    static void load(GLuint vbo, const std::vector<Vertex>& vertices, GLenum usage = GL_STATIC_DRAW) {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.empty() ? NULL : &vertices[0], usage);
+        set_attributes();
+    }
+
+    /**
+     * @brief       create a vertex array holding a vertex and an index buffer
+     *
+     * @param       vao         where the vertex array is written to
+     * @param       vbo         where the vertex (0) and index (1) buffers are written to
+     * @param       vertices    vertices
+     * @param       indices     indices
+     */
+    static void load_indexed(GLuint* vao, GLuint* vbo,
+                             const std::vector<Vertex>& vertices,
+                             const std::vector<unsigned int>& indices) {
+        glGenVertexArrays(1, vao);
+        GLState::get().bind_vertex_array(*vao);
+        glGenBuffers(2, vbo);
+
+        load(vbo[0], vertices);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo[1]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.empty() ? NULL : &indices[0], GL_STATIC_DRAW);
+
+        GLState::get().bind_vertex_array(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+};
+
+/**
+ * @brief       pack a unit vector into a signed normalized 10-10-10-2 word
+ *
+ * @param       n   unit vector
+ *
+ * @return      packed vector (w = 0)
+ */
+inline GLuint pack_normal(const glm::vec3& n) {
+    GLuint packed = 0;
+    for(unsigned int i=0; i<3; i++) {
+        const float c = std::min(std::max(n[i], -1.0f), 1.0f);
+        packed |= ((GLuint)(GLint)std::floor(c * 511.0f + 0.5f) & 0x3FF) << (i * 10);
+    }
+    return packed;
+}
+
+/**
+ * @brief       unpack a signed normalized 10-10-10-2 word
+ *
+ * @param       packed      packed vector
+ *
+ * @return      vector
+ */
+inline glm::vec3 unpack_normal(GLuint packed) {
+    glm::vec3 n;
+    for(unsigned int i=0; i<3; i++) {
+        GLint c = (packed >> (i * 10)) & 0x3FF;
+        if(c & 0x200) {
+            c -= 0x400;     // sign extension
+        }
+        n[i] = std::max((float)c / 511.0f, -1.0f);
+    }
+    return n;
+}
+
+/**
+ * @brief       pack a color into unsigned normalized bytes
+ *
+ * @param       color   rgb color
+ * @param       alpha   alpha
+ *
+ * @return      packed color
+ */
+inline glm::u8vec4 pack_color(const glm::vec3& color, float alpha = 1.0f) {
+    glm::u8vec4 packed;
+    for(unsigned int i=0; i<3; i++) {
+        packed[i] = (glm::uint8)std::floor(std::min(std::max(color[i], 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+    packed[3] = (glm::uint8)std::floor(std::min(std::max(alpha, 0.0f), 1.0f) * 255.0f + 0.5f);
+    return packed;
+}
+
+/*
+ * Common vertex types
+ */
+
+/**
+ * @struct VertexP
+ * @brief  position only (12 bytes)
+ */
+struct VertexP {
+    glm::vec3 position;
+};
+
+/**
+ * @struct VertexPN
+ * @brief  position and packed normal (16 bytes instead of 24)
+ */
+struct VertexPN {
+    glm::vec3 position;
+    GLuint normal;
+};
+
+/**
+ * @struct VertexPT
+ * @brief  screen position and texture coordinate
+ */
+struct VertexPT {
+    glm::vec2 position;
+    glm::vec2 texture_coordinate;
+};
+
+/**
+ * @struct VertexC
+ * @brief  packed color (4 bytes instead of 12), used as a separate stream
+ */
+struct VertexC {
+    glm::u8vec4 color;
+};
+
+typedef VertexLayout<VertexP,
+                     VertexAttribute<0, Float3, offsetof(VertexP, position)> > LayoutP;
+
+typedef VertexLayout<VertexPN,
+                     VertexAttribute<0, Float3, offsetof(VertexPN, position)>,
+                     VertexAttribute<1, PackedNormal, offsetof(VertexPN, normal)> > LayoutPN;
+
+typedef VertexLayout<VertexPT,
+                     VertexAttribute<0, Float2, offsetof(VertexPT, position)>,
+                     VertexAttribute<1, Float2, offsetof(VertexPT, texture_coordinate)> > LayoutPT;
+
+typedef VertexLayout<VertexC,
+                     VertexAttribute<2, PackedColor, offsetof(VertexC, color)> > LayoutC;
+
+#endif //_VERTEX_LAYOUT_H
@@ -30,7 +30,10 @@
  * @return void
  */
 void Visualizer::run(int argc, char* argv[]) {
-    if(argc > 2) {
+    // usage: acardov [--record <command log>]
+    if(argc == 3 && std::string(argv[1]) == "--record") {
+        Game::get().start_recording(argv[2], this->dt);
+    } else if(argc > 1) {
         std::cerr << "Invalid number of arguments" << std::endl;
     }
 
@@ -97,6 +100,10 @@ void Visualizer::run(int argc, char* argv[]) {
         // perform post-drawing operations (post processing)
         this->post_draw();
     }
+
+    if(Game::get().is_recording()) {
+        Game::get().stop_recording();
+    }
 }
 
 /**
@@ -166,6 +173,60 @@ void Visualizer::handle_char_callback(unsigned int key) {
 
 }
 
+void Visualizer::process_input() {
+    InputEvent event;
+
+    bool cursor_pending = false;
+    double cursor_x = 0.0;
+    double cursor_y = 0.0;
+
+    bool scroll_pending = false;
+    double scroll_x = 0.0;
+    double scroll_y = 0.0;
+
+    while(InputQueue::get().pop(&event)) {
+        if(event.type == InputEvent::CURSOR) {
+            cursor_pending = true;
+            cursor_x = event.x;
+            cursor_y = event.y;
+            continue;
+        }
+
+        if(event.type == InputEvent::SCROLL) {
+            scroll_pending = true;
+            scroll_x += event.x;
+            scroll_y += event.y;
+            continue;
+        }
+
+        // discrete events act on the cursor position at the time they occurred
+        if(cursor_pending) {
+            this->handle_mouse_cursor(cursor_x, cursor_y);
+            cursor_pending = false;
+        }
+
+        switch(event.type) {
+            case InputEvent::KEY:
+                this->handle_key_down(event.key, event.scancode, event.action, event.mods);
+            break;
+            case InputEvent::MOUSE_BUTTON:
+                this->handle_mouse_key_down(event.key, event.action, event.mods);
+            break;
+            case InputEvent::CHARACTER:
+                this->handle_char_callback((unsigned int)event.key);
+            break;
+        }
+    }
+
+    if(cursor_pending) {
+        this->handle_mouse_cursor(cursor_x, cursor_y);
+    }
+
+    if(scroll_pending) {
+        this->handle_scroll(scroll_x, scroll_y);
+    }
+}
+
 /**
  * @fn Game method
  * @brief Game constructor method
@@ -177,7 +238,9 @@ void Visualizer::handle_char_callback(unsigned int key) {
 Visualizer::Visualizer():
     accumulator(0.0),       /* default accumulator should be zero */
     fps(60.0),              /* set the target framerate */
-    num_frames(0) {
+    num_frames(0),
+    nr_gl_calls(0),
+    nr_gl_calls_eliminated(0) {
 
     this->angle = 0.0;
 
@@ -212,6 +275,7 @@ Visualizer::Visualizer():
  * @return Game class
  */
 void Visualizer::update(double dt) {
+    this->process_input();
     Game::get().update(dt);
     Light::get().update();
 }
@@ -227,6 +291,11 @@ void Visualizer::update_second() {
  *
  */
 void Visualizer::pre_draw() {
+    // keep the state call counts of the last frame for display and count this frame afresh
+    this->nr_gl_calls = GLState::get().get_nr_calls();
+    this->nr_gl_calls_eliminated = GLState::get().get_nr_calls_eliminated();
+    GLState::get().reset_counters();
+
     Screen::get().set_focus(glfwGetWindowAttrib(Display::get().get_window_ptr(), GLFW_FOCUSED));
     Display::get().open_frame();   /* start new frame */
 
@@ -236,10 +305,13 @@ void Visualizer::pre_draw() {
     // then perform the normal rendering in the PostProcessor texture
     PostProcessor::get().bind_frame_buffer();
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-    glEnable(GL_DEPTH_TEST);
+    GLState::get().enable(GL_DEPTH_TEST);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glViewport(0, 0, Screen::get().get_resolution_x(), Screen::get().get_resolution_y());
     Camera::get().update();
+
+    // upload the camera and light shared by all shaders
+    FrameData::get().update(glfwGetTime());
 }
 
 /**
@@ -251,6 +323,18 @@ void Visualizer::pre_draw() {
 void Visualizer::draw() {
     Game::get().draw();
     FontWriter::get().write_text(0, 50.f, 50.f, 0.f, glm::vec3(1,1,1), "Afelirin::Game Engine");
+
+    // driver overhead of the last frame
+    const RenderQueue& queue = RenderQueue::get();
+    FontWriter::get().write_text(0, 50.f, 75.f, 0.f, glm::vec3(1,1,1),
+                                 "GL state calls: " + boost::lexical_cast<std::string>(this->nr_gl_calls) +
+                                 " (" + boost::lexical_cast<std::string>(this->nr_gl_calls_eliminated) + " eliminated)  draws: " +
+                                 boost::lexical_cast<std::string>(queue.get_nr_draws()) + "  binds: " +
+                                 boost::lexical_cast<std::string>(queue.get_nr_state_changes()) + " (" +
+                                 boost::lexical_cast<std::string>(queue.get_nr_state_changes_saved()) + " saved by sorting)");
+
+    // execute the draws of the frame, sorted to minimise the state changes
+    RenderQueue::get().flush();
 }
 
 /**
@@ -261,8 +345,8 @@ void Visualizer::draw() {
  */
 void Visualizer::post_draw() {
     PostProcessor::get().unbind_frame_buffer();
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
+    GLState::get().enable(GL_DEPTH_TEST);
+    GLState::get().enable(GL_BLEND);
     glViewport(0, 0, Screen::get().get_width(), Screen::get().get_height());
     PostProcessor::get().draw();
     Display::get().close_frame();
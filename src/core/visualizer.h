@@ -29,6 +29,8 @@
 #include "core/screen.h"
 #include "core/font_writer.h"
 #include "core/light.h"
+#include "core/frame_data.h"
+#include "core/render_queue.h"
 #include "core/post_processor.h"
 #include "game/game.h"
 
@@ -77,6 +79,9 @@ private:
 
     unsigned int num_frames;
 
+    unsigned long int nr_gl_calls;              //!< GL state calls made in the last frame
+    unsigned long int nr_gl_calls_eliminated;   //!< of which dropped as redundant by GLState
+
     enum{
         STATE_VIEW,
         STATE_DRAG,
@@ -182,6 +187,18 @@ private:
      */
     void update(double dt);
 
+    /**
+     * @fn process_input method
+     * @brief Drains the input queue and dispatches the events to the handlers
+     *
+     * Runs once per update. Successive cursor events are coalesced into the
+     * last position and successive scroll events are summed, such that the
+     * camera maths are performed at most once per update regardless of the
+     * rate at which the devices report. Key and button events are dispatched
+     * in order, each seeing the cursor position at the time it occurred.
+     */
+    void process_input();
+
     /**
      * @brief Perform these actions at every second the program is running
      */
@@ -0,0 +1,336 @@
+/**************************************************************************
+ *   ai_player.cpp  --  This file is part of Acardov.                     *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "game/ai/ai_player.h"
+
+#include <algorithm>
+
+#include "core/job_system.h"
+
+constexpr float AIPlayer::WEIGHT_RESOURCES;
+constexpr float AIPlayer::WEIGHT_CLAIM;
+constexpr float AIPlayer::WEIGHT_CAPTURE;
+constexpr float AIPlayer::WEIGHT_DANGER;
+constexpr float AIPlayer::WEIGHT_ENEMY;
+constexpr float AIPlayer::WEIGHT_CROWD;
+constexpr float AIPlayer::DISCOUNT;
+
+/**
+ * @brief       advance a splitmix64 generator
+ *
+ * @param       state           state of the generator
+ *
+ * @return      random 64-bit value
+ */
+static inline uint64_t next_random(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief       constructor
+ *
+ * @param       _owner          player controlled by this AI
+ * @param       graph           range queries of the planet
+ * @param       _budget         search time per turn in seconds
+ * @param       _depth          number of steps per rollout
+ * @param       _rollouts       rollouts per worker and turn in deterministic mode
+ */
+AIPlayer::AIPlayer(unsigned int _owner, const TileRange& graph, double _budget, unsigned int _depth, unsigned int _rollouts) :
+    owner(_owner),
+    budget(_budget),
+    depth(std::max(1u, _depth)),
+    rollouts(std::max(1u, _rollouts)),
+    flag_deterministic(false),
+    speed(0.5f),
+    nr_turns(0) {
+
+    this->nr_workers = JobSystem::get().get_nr_threads();
+
+    // range queries keep scratch buffers, so every worker needs its own copy
+    this->ranges.assign(this->nr_workers, graph);
+}
+
+/**
+ * @brief       decide on the moves of the pieces of this player
+ *
+ * @param       store           entity store
+ * @param       movement        movement system
+ * @param       state           published state of the tile simulation
+ * @param       territories     owners of the tiles
+ * @param       hash            hash of the game
+ * @param       commands        vector to append the move commands to
+ */
+void AIPlayer::play(const EntityStore& store, const MovementSystem& movement,
+                    const TileState& state, const TileComponents& territories,
+                    uint64_t hash, std::vector<Command>* commands) {
+    const Clock::time_point deadline = Clock::now() +
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(this->budget));
+
+    this->view.capture(store, movement, state, territories, hash);
+
+    // every idle piece can stay or step onto a neighbouring tile
+    this->candidates.clear();
+    const std::vector<AIPiece>& pieces = this->view.get_pieces();
+    for(uint32_t i=0; i<pieces.size(); i++) {
+        if(pieces[i].owner != this->owner || pieces[i].flag_moving) {
+            continue;
+        }
+
+        Candidate candidate;
+        candidate.piece = i;
+        candidate.tile = pieces[i].tile;
+        this->candidates.push_back(candidate);
+        for(unsigned int neighbour: this->ranges[0].get_neighbours(pieces[i].tile)) {
+            candidate.tile = neighbour;
+            this->candidates.push_back(candidate);
+        }
+    }
+
+    if(this->candidates.empty()) {
+        return;
+    }
+
+    const size_t nr_candidates = this->candidates.size();
+    this->scores.assign(this->nr_workers * nr_candidates, 0.0);
+    this->counts.assign(this->nr_workers * nr_candidates, 0);
+
+    // the utilities depend on fields that are not part of the hash, hence start every turn afresh
+    CacheEntry empty;
+    empty.key = 0;
+    empty.utility = 0.0f;
+    this->cache.assign((size_t)this->nr_workers << CACHE_BITS, empty);
+
+    JobSystem::get().parallel_for(0, this->nr_workers, 1, [this, deadline](size_t begin, size_t end) {
+        for(size_t worker=begin; worker<end; worker++) {
+            this->search(worker, deadline);
+        }
+    });
+
+    // sum the rollouts of all workers into the slots of the first one
+    for(unsigned int w=1; w<this->nr_workers; w++) {
+        for(size_t i=0; i<nr_candidates; i++) {
+            this->scores[i] += this->scores[w * nr_candidates + i];
+            this->counts[i] += this->counts[w * nr_candidates + i];
+        }
+    }
+
+    this->assign(commands);
+    this->nr_turns++;
+}
+
+/**
+ * @brief       bound the search by a fixed number of rollouts rather than by time
+ *
+ * @param       deterministic   whether the moves may only depend on the state of the game
+ */
+void AIPlayer::set_deterministic(bool deterministic) {
+    this->flag_deterministic = deterministic;
+
+    // the rollouts (and the order in which their scores are summed) depend on the
+    // number of workers, hence it may not follow the number of cores
+    this->nr_workers = deterministic ? DETERMINISTIC_WORKERS : JobSystem::get().get_nr_threads();
+    const TileRange graph = this->ranges[0];
+    this->ranges.assign(this->nr_workers, graph);
+}
+
+/**
+ * @brief       get the number of rollouts performed in the last turn
+ */
+uint64_t AIPlayer::get_nr_rollouts() const {
+    uint64_t nr_rollouts = 0;
+    for(size_t i=0; i<this->candidates.size() && i<this->counts.size(); i++) {
+        nr_rollouts += this->counts[i];
+    }
+    return nr_rollouts;
+}
+
+/**
+ * @brief       perform rollouts until the deadline on a single worker
+ *
+ * @param       worker          worker id
+ * @param       deadline        time at which the search stops
+ */
+void AIPlayer::search(unsigned int worker, Clock::time_point deadline) {
+    const size_t nr_candidates = this->candidates.size();
+    double* scores = &this->scores[worker * nr_candidates];
+    uint32_t* counts = &this->counts[worker * nr_candidates];
+
+    // in deterministic mode the seeds only depend on the turn and the worker
+    WorldOverlay overlay(&this->view);
+    for(uint64_t i=worker, k=0; ; i+=this->nr_workers, k++) {
+        if(i >= nr_candidates) {
+            if(this->flag_deterministic ? k >= this->rollouts : Clock::now() >= deadline) {
+                break;
+            }
+        }
+
+        const size_t c = i % nr_candidates;
+        const uint64_t seed = (this->nr_turns << 40) ^ ((uint64_t)worker << 32) ^ k;
+        scores[c] += this->rollout(worker, &overlay, this->candidates[c], seed);
+        counts[c]++;
+    }
+}
+
+/**
+ * @brief       score a candidate by a single random rollout
+ *
+ * @param       worker          worker id
+ * @param       overlay         branch to play on (reset by this function)
+ * @param       candidate       candidate step
+ * @param       seed            random seed of the rollout
+ *
+ * @return      discounted sum of the utility over the rollout
+ */
+float AIPlayer::rollout(unsigned int worker, WorldOverlay* overlay, const Candidate& candidate, uint64_t seed) {
+    const unsigned int origin = this->view.get_pieces()[candidate.piece].tile;
+    const TileRange& range = this->ranges[worker];
+    uint64_t rng = seed;
+
+    overlay->reset();
+    unsigned int tile = candidate.tile;
+    float weight = 1.0f;
+    float score = 0.0f;
+
+    for(unsigned int step=0; ; step++) {
+        score += weight * this->cached_utility(worker, *overlay, tile, origin);
+        overlay->harvest(tile);
+        overlay->set_owner(tile, this->owner);
+
+        if(step + 1 >= this->depth) {
+            break;
+        }
+        weight *= DISCOUNT;
+
+        // continue greedily half of the time and randomly otherwise
+        const TileSet neighbours = range.get_neighbours(tile);
+        const uint64_t r = next_random(&rng);
+        if(r & 1) {
+            unsigned int best = neighbours[0];
+            float best_utility = this->cached_utility(worker, *overlay, best, origin);
+            for(size_t k=1; k<neighbours.size(); k++) {
+                const float u = this->cached_utility(worker, *overlay, neighbours[k], origin);
+                if(u > best_utility) {
+                    best_utility = u;
+                    best = neighbours[k];
+                }
+            }
+            tile = best;
+        } else {
+            tile = neighbours[(r >> 1) % neighbours.size()];
+        }
+    }
+
+    return score;
+}
+
+/**
+ * @brief       utility of a piece entering a tile
+ *
+ * @param       worker          worker id
+ * @param       overlay         branch to evaluate on
+ * @param       tile            tile the piece enters
+ * @param       origin          tile the piece started the turn on
+ */
+float AIPlayer::utility(unsigned int worker, const WorldOverlay& overlay, unsigned int tile, unsigned int origin) {
+    float u = WEIGHT_RESOURCES * overlay.get_resources(tile) - WEIGHT_DANGER * this->view.get_danger(tile);
+
+    const uint32_t tile_owner = overlay.get_owner(tile);
+    if(tile_owner == 0) {
+        u += WEIGHT_CLAIM;
+    } else if(tile_owner != this->owner) {
+        u += WEIGHT_CAPTURE;
+    }
+
+    const uint32_t occupant = this->view.get_occupant(tile);
+    if(occupant == this->owner && tile != origin) {
+        u -= WEIGHT_CROWD;
+    }
+
+    // enemy pieces within two steps
+    for(unsigned int nearby: this->ranges[worker].disc(tile, 2)) {
+        const uint32_t other = this->view.get_occupant(nearby);
+        if(other != 0 && other != this->owner) {
+            u -= WEIGHT_ENEMY;
+        }
+    }
+
+    return u;
+}
+
+/**
+ * @brief       utility of a piece entering a tile, looked up in the cache of the worker first
+ *
+ * @param       worker          worker id
+ * @param       overlay         branch to evaluate on
+ * @param       tile            tile the piece enters
+ * @param       origin          tile the piece started the turn on
+ */
+float AIPlayer::cached_utility(unsigned int worker, const WorldOverlay& overlay, unsigned int tile, unsigned int origin) {
+    // a key of zero marks an empty entry
+    const uint64_t key = (overlay.get_hash() ^ StateHash::mix(((uint64_t)tile << 32) | origin)) | 1;
+    CacheEntry& entry = this->cache[((size_t)worker << CACHE_BITS) + (key >> (64 - CACHE_BITS))];
+    if(entry.key != key) {
+        entry.key = key;
+        entry.utility = this->utility(worker, overlay, tile, origin);
+    }
+
+    return entry.utility;
+}
+
+/**
+ * @brief       pick a move per piece, such that no two pieces take the same tile
+ *
+ * @param       commands        vector to append the move commands to
+ */
+void AIPlayer::assign(std::vector<Command>* commands) const {
+    // candidates ordered by their mean score
+    std::vector<std::pair<double, size_t> > order;
+    order.reserve(this->candidates.size());
+    for(size_t i=0; i<this->candidates.size(); i++) {
+        if(this->counts[i] > 0) {
+            order.emplace_back(this->scores[i] / (double)this->counts[i], i);
+        }
+    }
+    std::sort(order.begin(), order.end(), [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    });
+
+    const std::vector<AIPiece>& pieces = this->view.get_pieces();
+    std::vector<bool> decided(pieces.size(), false);
+    std::vector<unsigned int> taken;
+    for(const auto& entry: order) {
+        const Candidate& candidate = this->candidates[entry.second];
+        if(decided[candidate.piece] ||
+           std::find(taken.begin(), taken.end(), candidate.tile) != taken.end()) {
+            continue;
+        }
+
+        decided[candidate.piece] = true;
+        taken.push_back(candidate.tile);
+
+        const AIPiece& piece = pieces[candidate.piece];
+        if(candidate.tile != piece.tile) {
+            commands->push_back(Command::move_piece(piece.entity, std::vector<unsigned int>(1, candidate.tile), this->speed));
+        }
+    }
+}
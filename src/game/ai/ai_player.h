@@ -0,0 +1,201 @@
+/**************************************************************************
+ *   ai_player.h  --  This file is part of Acardov.                       *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _AI_PLAYER_H
+#define _AI_PLAYER_H
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+#include "game/command.h"
+#include "game/ai/world_view.h"
+#include "game/terrain/tile_range.h"
+
+/**
+ * @class AIPlayer
+ * @brief Computer opponent that decides on the moves of its pieces
+ *
+ * Every turn, each idle piece of the player considers staying or stepping
+ * onto one of its neighbouring tiles. A candidate step is scored by random
+ * rollouts: the piece continues for a few more steps on a copy-on-write
+ * branch of the world, collecting resources and territory while avoiding
+ * danger, enemy pieces and its own pieces. The rollouts of all candidates
+ * are spread over one job per thread of the job system, which continue until
+ * the time budget of the turn is used; more cores therefore give more rollouts per candidate
+ * and better estimates.
+ *
+ * A search bounded by time depends on the load of the machine. In
+ * deterministic mode (headless runs) the search is instead spread over a
+ * fixed number of workers that each perform a fixed number of rollouts,
+ * seeded by the turn and the worker only, so that every run of the same
+ * game yields the same moves regardless of the number of cores.
+ *
+ * Rollouts of different candidates often pass through the same branch of
+ * the world. Every worker therefore keeps a cache of utilities, keyed by the
+ * hash of the branch together with the tile that is entered.
+ */
+class AIPlayer {
+private:
+    /**
+     * @struct Candidate
+     * @brief  possible first step of a piece
+     */
+    struct Candidate {
+        uint32_t piece;         //!< piece id in the world view
+        uint32_t tile;          //!< tile to step onto
+    };
+
+    /**
+     * @struct CacheEntry
+     * @brief  cached utility of entering a tile on a branch
+     */
+    struct CacheEntry {
+        uint64_t key;           //!< hash of the branch, tile and origin
+        float utility;          //!< cached utility
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    static const unsigned int CACHE_BITS = 12;          //!< log2 of the number of cache entries per worker
+    static const unsigned int DETERMINISTIC_WORKERS = 4; //!< number of search workers in deterministic mode
+
+    unsigned int owner;                 //!< player controlled by this AI
+    double budget;                      //!< search time per turn in seconds
+    unsigned int depth;                 //!< number of steps per rollout
+    unsigned int rollouts;              //!< rollouts per worker and turn in deterministic mode
+    bool flag_deterministic;            //!< whether the search is bounded by rollouts rather than time
+    float speed;                        //!< speed of the pieces in radians per second
+    unsigned int nr_workers;            //!< number of search threads
+    uint64_t nr_turns;                  //!< number of turns played
+
+    WorldView view;                     //!< state of the world at the start of the turn
+    std::vector<TileRange> ranges;      //!< range queries, one copy per worker
+    std::vector<Candidate> candidates;  //!< first steps of all pieces
+    std::vector<double> scores;         //!< summed rollout score per worker and candidate
+    std::vector<uint32_t> counts;       //!< number of rollouts per worker and candidate
+    std::vector<CacheEntry> cache;      //!< direct-mapped utility cache per worker
+
+    // weights of the utility
+    static constexpr float WEIGHT_RESOURCES = 1.0f;
+    static constexpr float WEIGHT_CLAIM = 0.3f;
+    static constexpr float WEIGHT_CAPTURE = 0.5f;
+    static constexpr float WEIGHT_DANGER = 2.0f;
+    static constexpr float WEIGHT_ENEMY = 0.5f;
+    static constexpr float WEIGHT_CROWD = 1.0f;
+    static constexpr float DISCOUNT = 0.8f;
+
+public:
+    /**
+     * @brief       constructor
+     *
+     * @param       _owner          player controlled by this AI
+     * @param       graph           range queries of the planet
+     * @param       _budget         search time per turn in seconds
+     * @param       _depth          number of steps per rollout
+     * @param       _rollouts       rollouts per worker and turn in deterministic mode
+     */
+    AIPlayer(unsigned int _owner, const TileRange& graph, double _budget, unsigned int _depth, unsigned int _rollouts);
+
+    /**
+     * @brief       decide on the moves of the pieces of this player
+     *
+     * @param       store           entity store
+     * @param       movement        movement system
+     * @param       state           published state of the tile simulation
+     * @param       territories     owners of the tiles
+     * @param       hash            hash of the game
+     * @param       commands        vector to append the move commands to
+     */
+    void play(const EntityStore& store, const MovementSystem& movement,
+              const TileState& state, const TileComponents& territories,
+              uint64_t hash, std::vector<Command>* commands);
+
+    inline unsigned int get_owner() const {
+        return this->owner;
+    }
+
+    /**
+     * @brief       bound the search by a fixed number of rollouts rather than by time
+     *
+     * @param       deterministic   whether the moves may only depend on the state of the game
+     */
+    void set_deterministic(bool deterministic);
+
+    /**
+     * @brief       get the number of rollouts performed in the last turn
+     */
+    uint64_t get_nr_rollouts() const;
+
+private:
+    /**
+     * @brief       perform rollouts until the deadline on a single worker
+     *
+     * Every worker first takes its share of one rollout per candidate,
+     * such that all candidates are scored irrespective of the budget. In
+     * deterministic mode the deadline is ignored and the worker stops after
+     * its fixed number of rollouts.
+     *
+     * @param       worker          worker id
+     * @param       deadline        time at which the search stops
+     */
+    void search(unsigned int worker, Clock::time_point deadline);
+
+    /**
+     * @brief       score a candidate by a single random rollout
+     *
+     * @param       worker          worker id
+     * @param       overlay         branch to play on (reset by this function)
+     * @param       candidate       candidate step
+     * @param       seed            random seed of the rollout
+     *
+     * @return      discounted sum of the utility over the rollout
+     */
+    float rollout(unsigned int worker, WorldOverlay* overlay, const Candidate& candidate, uint64_t seed);
+
+    /**
+     * @brief       utility of a piece entering a tile
+     *
+     * @param       worker          worker id
+     * @param       overlay         branch to evaluate on
+     * @param       tile            tile the piece enters
+     * @param       origin          tile the piece started the turn on
+     */
+    float utility(unsigned int worker, const WorldOverlay& overlay, unsigned int tile, unsigned int origin);
+
+    /**
+     * @brief       utility of a piece entering a tile, looked up in the cache of the worker first
+     *
+     * @param       worker          worker id
+     * @param       overlay         branch to evaluate on
+     * @param       tile            tile the piece enters
+     * @param       origin          tile the piece started the turn on
+     */
+    float cached_utility(unsigned int worker, const WorldOverlay& overlay, unsigned int tile, unsigned int origin);
+
+    /**
+     * @brief       pick a move per piece, such that no two pieces take the same tile
+     *
+     * @param       commands        vector to append the move commands to
+     */
+    void assign(std::vector<Command>* commands) const;
+};
+
+#endif //_AI_PLAYER_H
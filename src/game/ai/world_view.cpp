@@ -0,0 +1,131 @@
+/**************************************************************************
+ *   world_view.cpp  --  This file is part of Acardov.                    *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "game/ai/world_view.h"
+
+#include <algorithm>
+
+static const uint64_t SALT_HARVESTED = 0xA54FF53A5F1D36F1ULL;
+
+WorldView::WorldView() :
+    nr_tiles(0),
+    hash(0) {}
+
+/**
+ * @brief       copy the current state of the game
+ *
+ * @param       store           entity store
+ * @param       movement        movement system
+ * @param       state           published state of the tile simulation
+ * @param       territories     owners of the tiles
+ * @param       _hash           hash of the game
+ */
+void WorldView::capture(const EntityStore& store, const MovementSystem& movement,
+                        const TileState& state, const TileComponents& territories,
+                        uint64_t _hash) {
+    this->nr_tiles = state.get_nr_tiles();
+    this->hash = _hash;
+
+    const float* resources = state.get_field(TileState::RESOURCES);
+    this->resources.assign(resources, resources + this->nr_tiles);
+
+    const float* threat = state.get_field(TileState::THREAT);
+    const float* fire = state.get_field(TileState::FIRE);
+    this->danger.resize(this->nr_tiles);
+    for(unsigned int i=0; i<this->nr_tiles; i++) {
+        this->danger[i] = threat[i] + fire[i];
+    }
+
+    this->owners.resize(this->nr_tiles);
+    for(unsigned int i=0; i<this->nr_tiles; i++) {
+        this->owners[i] = territories.get_key(i);
+    }
+
+    this->occupants.assign(this->nr_tiles, 0);
+    this->pieces.resize(store.stats.size());
+    for(uint32_t i=0; i<store.stats.size(); i++) {
+        const uint32_t entity = store.stats.get_entity(i);
+
+        AIPiece& piece = this->pieces[i];
+        piece.entity = store.get_handle(entity);
+        piece.tile = store.locations.get(entity).tile;
+        piece.owner = store.stats[i].owner;
+        piece.flag_moving = movement.is_moving(piece.entity);
+
+        this->occupants[piece.tile] = piece.owner;
+    }
+}
+
+WorldOverlay::WorldOverlay(const WorldView* _base) :
+    base(_base),
+    hash(_base->get_hash()) {}
+
+/**
+ * @brief       drop all changes
+ */
+void WorldOverlay::reset() {
+    this->owners.clear();
+    this->harvested.clear();
+    this->hash = this->base->get_hash();
+}
+
+/**
+ * @brief       get the owner of a tile in this branch
+ */
+uint32_t WorldOverlay::get_owner(unsigned int tile) const {
+    for(auto it = this->owners.rbegin(); it != this->owners.rend(); ++it) {
+        if(it->first == tile) {
+            return it->second;
+        }
+    }
+
+    return this->base->get_owner(tile);
+}
+
+/**
+ * @brief       get the resources left on a tile in this branch
+ */
+float WorldOverlay::get_resources(unsigned int tile) const {
+    if(std::find(this->harvested.begin(), this->harvested.end(), tile) != this->harvested.end()) {
+        return 0.0f;
+    }
+
+    return this->base->get_resources(tile);
+}
+
+/**
+ * @brief       change the owner of a tile in this branch
+ */
+void WorldOverlay::set_owner(unsigned int tile, uint32_t owner) {
+    this->hash ^= StateHash::tile_owner(tile, this->get_owner(tile)) ^ StateHash::tile_owner(tile, owner);
+    this->owners.emplace_back(tile, owner);
+}
+
+/**
+ * @brief       collect the resources of a tile in this branch
+ */
+void WorldOverlay::harvest(unsigned int tile) {
+    if(std::find(this->harvested.begin(), this->harvested.end(), tile) != this->harvested.end()) {
+        return;
+    }
+
+    this->hash ^= StateHash::mix(tile ^ SALT_HARVESTED);
+    this->harvested.push_back(tile);
+}
@@ -0,0 +1,168 @@
+/**************************************************************************
+ *   world_view.h  --  This file is part of Acardov.                      *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _WORLD_VIEW_H
+#define _WORLD_VIEW_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+#include "game/entities/entity_store.h"
+#include "game/entities/movement_system.h"
+#include "game/terrain/tile_state.h"
+#include "game/terrain/tile_components.h"
+#include "game/state_hash.h"
+
+/**
+ * @struct AIPiece
+ * @brief  piece as seen by the AI
+ */
+struct AIPiece {
+    Entity entity;          //!< handle of the piece
+    uint32_t tile;          //!< tile the piece is on
+    uint32_t owner;         //!< owning player
+    bool flag_moving;       //!< whether the piece is on its way
+};
+
+/**
+ * @class WorldView
+ * @brief Read-only copy of the parts of the game the AI reasons about
+ *
+ * The view is captured once per turn on the main thread. It is never
+ * modified afterwards, such that all search threads can share it.
+ */
+class WorldView {
+private:
+    unsigned int nr_tiles;                  //!< number of tiles
+    uint64_t hash;                          //!< hash of the game
+    std::vector<float> resources;           //!< resources per tile
+    std::vector<float> danger;              //!< threat plus fire per tile
+    std::vector<uint32_t> owners;           //!< owner per tile
+    std::vector<uint32_t> occupants;        //!< owner of the pieces per tile (0 when empty)
+    std::vector<AIPiece> pieces;            //!< all pieces
+
+public:
+    WorldView();
+
+    /**
+     * @brief       copy the current state of the game
+     *
+     * @param       store           entity store
+     * @param       movement        movement system
+     * @param       state           published state of the tile simulation
+     * @param       territories     owners of the tiles
+     * @param       _hash           hash of the game
+     */
+    void capture(const EntityStore& store, const MovementSystem& movement,
+                 const TileState& state, const TileComponents& territories,
+                 uint64_t _hash);
+
+    inline unsigned int get_nr_tiles() const {
+        return this->nr_tiles;
+    }
+
+    inline uint64_t get_hash() const {
+        return this->hash;
+    }
+
+    inline float get_resources(unsigned int tile) const {
+        return this->resources[tile];
+    }
+
+    inline float get_danger(unsigned int tile) const {
+        return this->danger[tile];
+    }
+
+    inline uint32_t get_owner(unsigned int tile) const {
+        return this->owners[tile];
+    }
+
+    /**
+     * @brief       get the owner of the pieces on a tile
+     *
+     * @return      owner of (one of) the pieces or 0 when the tile is empty
+     */
+    inline uint32_t get_occupant(unsigned int tile) const {
+        return this->occupants[tile];
+    }
+
+    inline const std::vector<AIPiece>& get_pieces() const {
+        return this->pieces;
+    }
+};
+
+/**
+ * @class WorldOverlay
+ * @brief Copy-on-write branch on top of a world view
+ *
+ * A branch only stores what it changed with respect to the view; everything
+ * else is read through to the view. Branching therefore never copies the
+ * world, and since a rollout only changes a handful of tiles, the short
+ * lists of changes are faster to search than any map.
+ *
+ * The hash of the branch starts from the hash of the game and is updated
+ * with every change, such that equal branches have equal hashes.
+ */
+class WorldOverlay {
+private:
+    const WorldView* base;                                  //!< shared view
+    std::vector<std::pair<uint32_t, uint32_t> > owners;     //!< changed owners (tile, owner)
+    std::vector<uint32_t> harvested;                        //!< tiles whose resources are collected
+    uint64_t hash;                                          //!< hash of the branch
+
+public:
+    WorldOverlay(const WorldView* _base);
+
+    /**
+     * @brief       drop all changes
+     */
+    void reset();
+
+    /**
+     * @brief       get the owner of a tile in this branch
+     */
+    uint32_t get_owner(unsigned int tile) const;
+
+    /**
+     * @brief       get the resources left on a tile in this branch
+     */
+    float get_resources(unsigned int tile) const;
+
+    /**
+     * @brief       change the owner of a tile in this branch
+     */
+    void set_owner(unsigned int tile, uint32_t owner);
+
+    /**
+     * @brief       collect the resources of a tile in this branch
+     */
+    void harvest(unsigned int tile);
+
+    inline uint64_t get_hash() const {
+        return this->hash;
+    }
+
+    inline const WorldView& get_base() const {
+        return *this->base;
+    }
+};
+
+#endif //_WORLD_VIEW_H
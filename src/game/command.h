@@ -0,0 +1,112 @@
+/**************************************************************************
+ *   command.h  --  This file is part of Acardov.                         *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _COMMAND_H
+#define _COMMAND_H
+
+#include <vector>
+#include <cstdint>
+
+#include "game/entities/component_array.h"
+
+/**
+ * @struct Command
+ * @brief  single action of a player or an AI on the game
+ *
+ * Every change to the game that originates from a player or an AI is issued
+ * as a command, such that a match can be recorded and replayed. Only the
+ * members relevant for the type of the command are used.
+ */
+struct Command {
+    uint32_t type;                      //!< command type
+    Entity piece;                       //!< piece the command acts on
+    uint32_t tile;                      //!< target tile
+    uint32_t value;                     //!< piece type, owner or field id
+    uint32_t owner;                     //!< owner of a new piece
+    float amount;                       //!< speed or field value
+    std::vector<unsigned int> path;     //!< tiles to visit
+
+    enum {
+        ADD_PIECE,          //!< place a piece of type value and owner on tile
+        SET_PIECE_TILE,     //!< put piece on tile
+        MOVE_PIECE,         //!< let piece walk over path at speed amount
+        REMOVE_PIECE,       //!< remove piece
+        SET_TILE_OWNER,     //!< give tile to owner value
+        SET_TILE_VALUE,     //!< set field value of tile to amount
+        NR_COMMANDS
+    };
+
+    Command() : type(0), tile(0), value(0), owner(0), amount(0.0f) {
+        this->piece.index = 0;
+        this->piece.generation = 0;
+    }
+
+    static Command add_piece(unsigned int tile, unsigned int type, unsigned int owner) {
+        Command command;
+        command.type = ADD_PIECE;
+        command.tile = tile;
+        command.value = type;
+        command.owner = owner;
+        return command;
+    }
+
+    static Command set_piece_tile(Entity piece, unsigned int tile) {
+        Command command;
+        command.type = SET_PIECE_TILE;
+        command.piece = piece;
+        command.tile = tile;
+        return command;
+    }
+
+    static Command move_piece(Entity piece, const std::vector<unsigned int>& path, float speed) {
+        Command command;
+        command.type = MOVE_PIECE;
+        command.piece = piece;
+        command.path = path;
+        command.amount = speed;
+        return command;
+    }
+
+    static Command remove_piece(Entity piece) {
+        Command command;
+        command.type = REMOVE_PIECE;
+        command.piece = piece;
+        return command;
+    }
+
+    static Command set_tile_owner(unsigned int tile, unsigned int owner) {
+        Command command;
+        command.type = SET_TILE_OWNER;
+        command.tile = tile;
+        command.value = owner;
+        return command;
+    }
+
+    static Command set_tile_value(unsigned int tile, unsigned int field, float value) {
+        Command command;
+        command.type = SET_TILE_VALUE;
+        command.tile = tile;
+        command.value = field;
+        command.amount = value;
+        return command;
+    }
+};
+
+#endif //_COMMAND_H
@@ -0,0 +1,351 @@
+/**************************************************************************
+ *   command_log.cpp  --  This file is part of Acardov.                   *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "game/command_log.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+
+static const char COMMAND_LOG_MAGIC[8] = {'A', 'C', 'A', 'R', 'D', 'R', 'P', 'L'};
+static const uint32_t COMMAND_LOG_VERSION = 2;
+
+CommandLog::CommandLog() :
+    dt(0.0),
+    nr_updates(0),
+    nr_commands(0),
+    last_update(0),
+    checksum_interval(CHECKSUM_INTERVAL) {}
+
+/**
+ * @brief       remove all commands and start a new recording
+ *
+ * @param       _dt             game time per update in seconds
+ */
+void CommandLog::clear(double _dt) {
+    this->dt = _dt;
+    this->nr_updates = 0;
+    this->nr_commands = 0;
+    this->last_update = 0;
+    this->data.clear();
+    this->checksum_interval = CHECKSUM_INTERVAL;
+    this->checksums.clear();
+}
+
+/**
+ * @brief       record a command
+ *
+ * @param       update          update the command is executed in
+ * @param       command         the command
+ */
+void CommandLog::append(uint64_t update, const Command& command) {
+    this->put_varint(update - this->last_update);
+    this->put_varint(command.type);
+
+    switch(command.type) {
+        case Command::ADD_PIECE:
+            this->put_varint(command.tile);
+            this->put_varint(command.value);
+            this->put_varint(command.owner);
+        break;
+        case Command::SET_PIECE_TILE:
+            this->put_varint(command.piece.index);
+            this->put_varint(command.piece.generation);
+            this->put_varint(command.tile);
+        break;
+        case Command::MOVE_PIECE:
+            this->put_varint(command.piece.index);
+            this->put_varint(command.piece.generation);
+            this->put_float(command.amount);
+            this->put_varint(command.path.size());
+            for(unsigned int tile: command.path) {
+                this->put_varint(tile);
+            }
+        break;
+        case Command::REMOVE_PIECE:
+            this->put_varint(command.piece.index);
+            this->put_varint(command.piece.generation);
+        break;
+        case Command::SET_TILE_OWNER:
+            this->put_varint(command.tile);
+            this->put_varint(command.value);
+        break;
+        case Command::SET_TILE_VALUE:
+            this->put_varint(command.tile);
+            this->put_varint(command.value);
+            this->put_float(command.amount);
+        break;
+        default:
+            std::cerr << "[ERROR] Cannot record unknown command type " << command.type << std::endl;
+        break;
+    }
+
+    this->last_update = update;
+    this->nr_commands++;
+}
+
+/**
+ * @brief       decode the next command
+ *
+ * @param       pos             byte position in the log, advanced past the command
+ * @param       update          update of the previous command on entry, of this command on return
+ * @param       command         command to write to
+ *
+ * @return      false at the end of the log or when the log is corrupt
+ */
+bool CommandLog::decode(size_t* pos, uint64_t* update, Command* command) const {
+    uint64_t delta, type, a, b, c;
+    if(!this->get_varint(pos, &delta) || !this->get_varint(pos, &type)) {
+        return false;
+    }
+
+    *command = Command();
+    command->type = type;
+
+    switch(type) {
+        case Command::ADD_PIECE:
+            if(!this->get_varint(pos, &a) || !this->get_varint(pos, &b) || !this->get_varint(pos, &c)) {
+                return false;
+            }
+            command->tile = a;
+            command->value = b;
+            command->owner = c;
+        break;
+        case Command::SET_TILE_OWNER:
+            if(!this->get_varint(pos, &a) || !this->get_varint(pos, &b)) {
+                return false;
+            }
+            command->tile = a;
+            command->value = b;
+        break;
+        case Command::SET_PIECE_TILE:
+            if(!this->get_varint(pos, &a) || !this->get_varint(pos, &b) || !this->get_varint(pos, &c)) {
+                return false;
+            }
+            command->piece.index = a;
+            command->piece.generation = b;
+            command->tile = c;
+        break;
+        case Command::MOVE_PIECE:
+            if(!this->get_varint(pos, &a) || !this->get_varint(pos, &b) ||
+               !this->get_float(pos, &command->amount) || !this->get_varint(pos, &c)) {
+                return false;
+            }
+            command->piece.index = a;
+            command->piece.generation = b;
+            if(c > this->data.size() - *pos) {    // every tile takes at least one byte
+                return false;
+            }
+            command->path.resize(c);
+            for(uint64_t i=0; i<c; i++) {
+                if(!this->get_varint(pos, &a)) {
+                    return false;
+                }
+                command->path[i] = a;
+            }
+        break;
+        case Command::REMOVE_PIECE:
+            if(!this->get_varint(pos, &a) || !this->get_varint(pos, &b)) {
+                return false;
+            }
+            command->piece.index = a;
+            command->piece.generation = b;
+        break;
+        case Command::SET_TILE_VALUE:
+            if(!this->get_varint(pos, &a) || !this->get_varint(pos, &b) || !this->get_float(pos, &command->amount)) {
+                return false;
+            }
+            command->tile = a;
+            command->value = b;
+        break;
+        default:
+            return false;
+    }
+
+    *update += delta;
+    return true;
+}
+
+/**
+ * @brief       write the log to a file
+ *
+ * @param       filename        path to the file
+ *
+ * @return      whether the file was written
+ */
+bool CommandLog::write(const std::string& filename) const {
+    CommandLogHeader header;
+    std::memset(&header, 0, sizeof(CommandLogHeader));
+    std::memcpy(header.magic, COMMAND_LOG_MAGIC, sizeof(COMMAND_LOG_MAGIC));
+    header.version = COMMAND_LOG_VERSION;
+    header.checksum_interval = this->checksum_interval;
+    header.dt = this->dt;
+    header.nr_updates = this->nr_updates;
+    header.nr_commands = this->nr_commands;
+    header.data_size = this->data.size();
+    header.nr_checksums = this->checksums.size();
+
+    std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+    if(!out.is_open()) {
+        std::cerr << "[ERROR] Cannot write command log " << filename << std::endl;
+        return false;
+    }
+
+    out.write((const char*)&header, sizeof(CommandLogHeader));
+    if(!this->data.empty()) {
+        out.write((const char*)&this->data[0], this->data.size());
+    }
+    if(!this->checksums.empty()) {
+        out.write((const char*)&this->checksums[0], this->checksums.size() * sizeof(uint64_t));
+    }
+
+    if(!out.good()) {
+        std::cerr << "[ERROR] Could not complete writing command log " << filename << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief       read a log from a file
+ *
+ * @param       filename        path to the file
+ *
+ * @return      whether the file is a valid command log
+ */
+bool CommandLog::read(const std::string& filename) {
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    if(!in.is_open()) {
+        std::cerr << "[ERROR] Cannot open command log " << filename << std::endl;
+        return false;
+    }
+
+    CommandLogHeader header;
+    in.read((char*)&header, sizeof(CommandLogHeader));
+    if(!in.good() ||
+       std::memcmp(header.magic, COMMAND_LOG_MAGIC, sizeof(COMMAND_LOG_MAGIC)) != 0 ||
+       header.version != COMMAND_LOG_VERSION ||
+       header.checksum_interval == 0 ||
+       !(header.dt > 0.0)) {
+        std::cerr << "[ERROR] " << filename << " is not a valid command log" << std::endl;
+        return false;
+    }
+
+    // the sections should exactly fill the file
+    const std::streamoff begin = in.tellg();
+    in.seekg(0, std::ios::end);
+    const uint64_t remaining = (uint64_t)(in.tellg() - begin);
+    in.seekg(begin);
+    if(header.data_size > remaining || header.nr_checksums != (remaining - header.data_size) / sizeof(uint64_t)) {
+        std::cerr << "[ERROR] Command log " << filename << " is truncated" << std::endl;
+        return false;
+    }
+
+    std::vector<uint8_t> buffer(header.data_size);
+    std::vector<uint64_t> checksums(header.nr_checksums);
+    if(!buffer.empty()) {
+        in.read((char*)&buffer[0], buffer.size());
+    }
+    if(!checksums.empty()) {
+        in.read((char*)&checksums[0], checksums.size() * sizeof(uint64_t));
+    }
+    if(!in.good()) {
+        std::cerr << "[ERROR] Command log " << filename << " is truncated" << std::endl;
+        return false;
+    }
+
+    this->dt = header.dt;
+    this->nr_updates = header.nr_updates;
+    this->nr_commands = header.nr_commands;
+    this->data.swap(buffer);
+    this->checksum_interval = header.checksum_interval;
+    this->checksums.swap(checksums);
+
+    // find the update of the last command, such that the log can be extended
+    size_t pos = 0;
+    uint64_t update = 0;
+    uint64_t nr_commands = 0;
+    Command command;
+    while(this->decode(&pos, &update, &command)) {
+        nr_commands++;
+    }
+    if(pos != this->data.size() || nr_commands != this->nr_commands) {
+        std::cerr << "[ERROR] Command log " << filename << " is corrupt" << std::endl;
+        this->clear(header.dt);
+        return false;
+    }
+    this->last_update = update;
+
+    return true;
+}
+
+/**
+ * @brief       append an unsigned integer in LEB128 encoding
+ */
+void CommandLog::put_varint(uint64_t value) {
+    while(value >= 0x80) {
+        this->data.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    this->data.push_back((uint8_t)value);
+}
+
+/**
+ * @brief       append a float by its bit pattern
+ */
+void CommandLog::put_float(float value) {
+    uint8_t bytes[sizeof(float)];
+    std::memcpy(bytes, &value, sizeof(float));
+    this->data.insert(this->data.end(), bytes, bytes + sizeof(float));
+}
+
+/**
+ * @brief       read an unsigned integer in LEB128 encoding
+ */
+bool CommandLog::get_varint(size_t* pos, uint64_t* value) const {
+    *value = 0;
+    for(unsigned int shift=0; shift<64; shift+=7) {
+        if(*pos >= this->data.size()) {
+            return false;
+        }
+
+        const uint8_t byte = this->data[(*pos)++];
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief       read a float by its bit pattern
+ */
+bool CommandLog::get_float(size_t* pos, float* value) const {
+    if(this->data.size() - *pos < sizeof(float)) {
+        return false;
+    }
+
+    std::memcpy(value, &this->data[*pos], sizeof(float));
+    *pos += sizeof(float);
+    return true;
+}
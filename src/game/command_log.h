@@ -0,0 +1,181 @@
+/**************************************************************************
+ *   command_log.h  --  This file is part of Acardov.                     *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _COMMAND_LOG_H
+#define _COMMAND_LOG_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "game/command.h"
+
+/**
+ * @struct CommandLogHeader
+ * @brief  header at the start of every command log file
+ */
+struct CommandLogHeader {
+    char magic[8];              //!< file identifier
+    uint32_t version;           //!< version of the format
+    uint32_t checksum_interval; //!< updates in between checksums
+    double dt;                  //!< game time per update in seconds
+    uint64_t nr_updates;        //!< length of the recording in updates
+    uint64_t nr_commands;       //!< number of recorded commands
+    uint64_t data_size;         //!< size of the encoded commands in bytes
+    uint64_t nr_checksums;      //!< number of checksums behind the commands
+};
+
+/**
+ * @class CommandLog
+ * @brief Compact binary record of the commands issued during a match
+ *
+ * Every command is stamped with the game update it was executed in, counted
+ * from the start of the recording. Commands are stored back to back as
+ * variable-length integers: the number of updates since the previous
+ * command, the command type and the members used by that type. A typical
+ * command takes only a handful of bytes.
+ *
+ * Behind the commands, the log holds a checksum (the hash of the game) for
+ * every simulation tick, such that a replay that diverges from the original
+ * match is detected right where it happens.
+ */
+class CommandLog {
+private:
+    double dt;                          //!< game time per update in seconds
+    uint64_t nr_updates;                //!< length of the recording in updates
+    uint64_t nr_commands;               //!< number of recorded commands
+    uint64_t last_update;               //!< update of the last recorded command
+    std::vector<uint8_t> data;          //!< encoded commands
+    unsigned int checksum_interval;     //!< updates in between checksums
+    std::vector<uint64_t> checksums;    //!< hash of the game after every interval
+
+public:
+    static const unsigned int CHECKSUM_INTERVAL = 6;   //!< default, one simulation tick at 60 updates per second
+
+    CommandLog();
+
+    /**
+     * @brief       remove all commands and start a new recording
+     *
+     * @param       _dt             game time per update in seconds
+     */
+    void clear(double _dt);
+
+    /**
+     * @brief       record a command
+     *
+     * @param       update          update the command is executed in
+     * @param       command         the command
+     */
+    void append(uint64_t update, const Command& command);
+
+    /**
+     * @brief       record the hash of the game after a checksum interval
+     *
+     * @param       checksum        hash of the game
+     */
+    inline void add_checksum(uint64_t checksum) {
+        this->checksums.push_back(checksum);
+    }
+
+    /**
+     * @brief       decode the next command
+     *
+     * @param       pos             byte position in the log, advanced past the command
+     * @param       update          update of the previous command on entry, of this command on return
+     * @param       command         command to write to
+     *
+     * @return      false at the end of the log or when the log is corrupt
+     */
+    bool decode(size_t* pos, uint64_t* update, Command* command) const;
+
+    /**
+     * @brief       write the log to a file
+     *
+     * @param       filename        path to the file
+     *
+     * @return      whether the file was written
+     */
+    bool write(const std::string& filename) const;
+
+    /**
+     * @brief       read a log from a file
+     *
+     * @param       filename        path to the file
+     *
+     * @return      whether the file is a valid command log
+     */
+    bool read(const std::string& filename);
+
+    inline void set_nr_updates(uint64_t _nr_updates) {
+        this->nr_updates = _nr_updates;
+    }
+
+    inline uint64_t get_nr_updates() const {
+        return this->nr_updates;
+    }
+
+    inline uint64_t get_nr_commands() const {
+        return this->nr_commands;
+    }
+
+    inline double get_dt() const {
+        return this->dt;
+    }
+
+    inline unsigned int get_checksum_interval() const {
+        return this->checksum_interval;
+    }
+
+    inline size_t get_nr_checksums() const {
+        return this->checksums.size();
+    }
+
+    inline uint64_t get_checksum(size_t i) const {
+        return this->checksums[i];
+    }
+
+    inline size_t get_size() const {
+        return this->data.size();
+    }
+
+private:
+    /**
+     * @brief       append an unsigned integer in LEB128 encoding
+     */
+    void put_varint(uint64_t value);
+
+    /**
+     * @brief       append a float by its bit pattern
+     */
+    void put_float(float value);
+
+    /**
+     * @brief       read an unsigned integer in LEB128 encoding
+     */
+    bool get_varint(size_t* pos, uint64_t* value) const;
+
+    /**
+     * @brief       read a float by its bit pattern
+     */
+    bool get_float(size_t* pos, float* value) const;
+};
+
+#endif //_COMMAND_LOG_H
@@ -0,0 +1,109 @@
+/**************************************************************************
+ *   archetypes.cpp  --  This file is part of Acardov.                    *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+#include "game/entities/archetypes.h"
+
+Archetypes::Archetypes() {
+    this->archetypes_file = AssetManager::get().get_root_directory() + "assets/configuration/archetypes.json";
+    this->load();
+}
+
+/**
+ * @brief       find the piece type of an archetype by its name
+ *
+ * @param       name    name of the archetype
+ *
+ * @return      piece type or the number of archetypes when there is no such archetype
+ */
+unsigned int Archetypes::find(const std::string& name) const {
+    for(unsigned int i=0; i<this->names.size(); i++) {
+        if(this->names[i] == name) {
+            return i;
+        }
+    }
+
+    return this->names.size();
+}
+
+/**
+ * @brief       read the archetypes and compile them into templates
+ */
+void Archetypes::load() {
+    boost::property_tree::ptree root;
+
+    try {
+        boost::property_tree::read_json(this->archetypes_file, root);
+
+        BOOST_FOREACH(const boost::property_tree::ptree::value_type& node, root.get_child("archetypes")) {
+            const boost::property_tree::ptree& entry = node.second;
+
+            PieceArchetype archetype;
+
+            archetype.transform.position = glm::vec3(0.0f);
+            archetype.transform.rotation = glm::quat();
+            archetype.transform.scale = entry.get<float>("scale");
+            archetype.transform.model = glm::mat4(1.0f);
+            archetype.transform.dirty = true;
+
+            archetype.parts.nr_parts = 0;
+            BOOST_FOREACH(const boost::property_tree::ptree::value_type& part, entry.get_child("parts")) {
+                if(archetype.parts.nr_parts == RenderParts::MAX_PARTS) {
+                    std::cerr << "[ERROR] Archetype " << entry.get<std::string>("name")
+                              << " has more than " << RenderParts::MAX_PARTS << " parts; ignoring the rest" << std::endl;
+                    break;
+                }
+
+                const unsigned int i = archetype.parts.nr_parts++;
+                archetype.parts.meshes[i] = this->get_mesh_id(part.second.get<std::string>("mesh"));
+                archetype.parts.colors[i] = hex2col(part.second.get<std::string>("color"));
+            }
+
+            archetype.stats.type = this->archetypes.size();
+            archetype.stats.owner = 0;
+            archetype.stats.health = entry.get<float>("health");
+            archetype.stats.strength = entry.get<float>("strength");
+
+            this->archetypes.push_back(archetype);
+            this->names.push_back(entry.get<std::string>("name"));
+        }
+    } catch(std::exception const& ex) {
+        std::cerr << "[ERROR] There was an error parsing " << this->archetypes_file << std::endl;
+        std::cerr << ex.what() << std::endl;
+        std::cerr << "[ERROR] Terminating program" << std::endl;
+        exit(-1);
+    }
+}
+
+/**
+ * @brief       get the mesh id of a mesh file, assigning a new one when it is not known yet
+ *
+ * @param       filename        path of the mesh file
+ *
+ * @return      mesh id
+ */
+unsigned int Archetypes::get_mesh_id(const std::string& filename) {
+    for(unsigned int i=0; i<this->mesh_files.size(); i++) {
+        if(this->mesh_files[i] == filename) {
+            return i;
+        }
+    }
+
+    this->mesh_files.push_back(filename);
+    return this->mesh_files.size() - 1;
+}
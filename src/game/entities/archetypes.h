@@ -0,0 +1,114 @@
+/**************************************************************************
+ *   archetypes.h  --  This file is part of Acardov.                      *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+#ifndef _ARCHETYPES_H
+#define _ARCHETYPES_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/foreach.hpp>
+
+#include "core/asset_manager.h"
+#include "game/entities/components.h"
+#include "util/mathfunc.h"
+
+/**
+ * @struct PieceArchetype
+ * @brief  template from which pieces are spawned
+ *
+ * The archetype holds the components a new piece starts with. It is a flat
+ * structure without any allocations, such that spawning a piece amounts to
+ * copying it into the component arrays.
+ */
+struct PieceArchetype {
+    Transform transform;    //!< initial placement (only the scale is used)
+    RenderParts parts;      //!< meshes to draw
+    PieceStats stats;       //!< initial stats (the owner is set upon spawning)
+};
+
+/**
+ * @class Archetypes
+ * @brief Piece archetypes as defined in assets/configuration/archetypes.json
+ *
+ * The type of a piece is the position of its archetype in the file. The
+ * meshes are referred to by their file name; every distinct file is given
+ * a mesh id, in the order in which they first appear.
+ */
+class Archetypes {
+private:
+    std::string archetypes_file;
+
+    std::vector<PieceArchetype> archetypes;     //!< compiled archetypes per type
+    std::vector<std::string> names;             //!< name per type
+    std::vector<std::string> mesh_files;        //!< file name per mesh id
+
+public:
+    static Archetypes& get() {
+        static Archetypes archetypes_instance;
+        return archetypes_instance;
+    }
+
+    inline unsigned int get_nr_archetypes() const {
+        return this->archetypes.size();
+    }
+
+    /**
+     * @brief       get the archetype of a piece type
+     *
+     * @param       type    piece type (should be smaller than the number of archetypes)
+     */
+    inline const PieceArchetype& get_archetype(unsigned int type) const {
+        return this->archetypes[type];
+    }
+
+    inline const std::string& get_name(unsigned int type) const {
+        return this->names[type];
+    }
+
+    /**
+     * @brief       find the piece type of an archetype by its name
+     *
+     * @param       name    name of the archetype
+     *
+     * @return      piece type or the number of archetypes when there is no such archetype
+     */
+    unsigned int find(const std::string& name) const;
+
+    /**
+     * @brief       get the file names of the meshes, indexed by mesh id
+     */
+    inline const std::vector<std::string>& get_mesh_files() const {
+        return this->mesh_files;
+    }
+
+private:
+    Archetypes();
+
+    void load();
+
+    unsigned int get_mesh_id(const std::string& filename);
+
+    Archetypes(Archetypes const&)          = delete;
+    void operator=(Archetypes const&)  = delete;
+};
+
+#endif //_ARCHETYPES_H
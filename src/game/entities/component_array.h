@@ -0,0 +1,171 @@
+/**************************************************************************
+ *   component_array.h  --  This file is part of Acardov.                 *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _COMPONENT_ARRAY_H
+#define _COMPONENT_ARRAY_H
+
+#include <vector>
+#include <cstdint>
+
+/**
+ * @struct Entity
+ * @brief  handle to an entity
+ *
+ * The generation is increased every time the slot of an entity is reused,
+ * such that stale handles can be detected.
+ */
+struct Entity {
+    uint32_t index;         //!< slot of the entity
+    uint32_t generation;    //!< generation of the slot at creation
+
+    inline bool operator==(const Entity& other) const {
+        return this->index == other.index && this->generation == other.generation;
+    }
+
+    inline bool operator!=(const Entity& other) const {
+        return !(*this == other);
+    }
+};
+
+/**
+ * @class ComponentArray
+ * @brief Packed storage of a single component type
+ *
+ * The components are stored contiguously in a dense array, accompanied by
+ * the index of the entity each component belongs to. A sparse array maps
+ * entity indices onto positions in the dense array. Removal moves the last
+ * component into the gap (swap-and-pop), hence the dense array never has
+ * holes and systems can iterate over it directly.
+ */
+template <typename T>
+class ComponentArray {
+private:
+    static const uint32_t INVALID = 0xFFFFFFFF;
+
+    std::vector<T> components;          //!< packed components
+    std::vector<uint32_t> entities;     //!< entity index per component
+    std::vector<uint32_t> lookup;       //!< position in the packed array per entity index
+
+public:
+    /**
+     * @brief       reserve memory for a number of entities
+     *
+     * @param       capacity        number of entities
+     */
+    void reserve(uint32_t capacity) {
+        this->components.reserve(capacity);
+        this->entities.reserve(capacity);
+        this->lookup.reserve(capacity);
+    }
+
+    /**
+     * @brief       attach a component to an entity (or overwrite it)
+     *
+     * @param       entity          entity index
+     * @param       component       component value
+     *
+     * @return      reference to the stored component
+     */
+    T& add(uint32_t entity, const T& component) {
+        if(entity >= this->lookup.size()) {
+            this->lookup.resize(entity + 1, INVALID);
+        }
+
+        if(this->lookup[entity] != INVALID) {
+            return (this->components[this->lookup[entity]] = component);
+        }
+
+        this->lookup[entity] = this->components.size();
+        this->components.push_back(component);
+        this->entities.push_back(entity);
+
+        return this->components.back();
+    }
+
+    /**
+     * @brief       detach the component from an entity (if present)
+     *
+     * @param       entity          entity index
+     */
+    void remove(uint32_t entity) {
+        if(!this->has(entity)) {
+            return;
+        }
+
+        const uint32_t pos = this->lookup[entity];
+        const uint32_t last = this->components.size() - 1;
+
+        // move the last component into the gap
+        if(pos != last) {
+            this->components[pos] = this->components[last];
+            this->entities[pos] = this->entities[last];
+            this->lookup[this->entities[pos]] = pos;
+        }
+
+        this->components.pop_back();
+        this->entities.pop_back();
+        this->lookup[entity] = INVALID;
+    }
+
+    inline bool has(uint32_t entity) const {
+        return entity < this->lookup.size() && this->lookup[entity] != INVALID;
+    }
+
+    inline T& get(uint32_t entity) {
+        return this->components[this->lookup[entity]];
+    }
+
+    inline const T& get(uint32_t entity) const {
+        return this->components[this->lookup[entity]];
+    }
+
+    inline uint32_t size() const {
+        return this->components.size();
+    }
+
+    /**
+     * @brief       get the component at a position in the packed array
+     */
+    inline T& operator[](uint32_t i) {
+        return this->components[i];
+    }
+
+    inline const T& operator[](uint32_t i) const {
+        return this->components[i];
+    }
+
+    /**
+     * @brief       get the entity index of the component at a position in the packed array
+     */
+    inline uint32_t get_entity(uint32_t i) const {
+        return this->entities[i];
+    }
+
+    inline void clear() {
+        this->components.clear();
+        this->entities.clear();
+        this->lookup.clear();
+    }
+};
+
+template <typename T>
+const uint32_t ComponentArray<T>::INVALID;
+
+#endif //_COMPONENT_ARRAY_H
@@ -0,0 +1,79 @@
+/**************************************************************************
+ *   components.h  --  This file is part of Acardov.                      *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _COMPONENTS_H
+#define _COMPONENTS_H
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+/**
+ * @struct Transform
+ * @brief  placement of an entity in world space
+ *
+ * The model matrix is cached; whoever changes the placement has to set
+ * the dirty flag, such that the matrix is rebuilt before the next draw.
+ */
+struct Transform {
+    glm::vec3 position;     //!< position
+    glm::quat rotation;     //!< orientation
+    float scale;            //!< uniform scale
+
+    glm::mat4 model;        //!< cached model matrix
+    bool dirty;             //!< whether the model matrix is out of date
+};
+
+/**
+ * @struct TileLocation
+ * @brief  tile an entity is standing on
+ */
+struct TileLocation {
+    unsigned int tile;      //!< tile id
+};
+
+/**
+ * @struct RenderParts
+ * @brief  meshes an entity is drawn with
+ *
+ * The number of parts is bounded, such that the parts are stored inline
+ * rather than in separate allocations.
+ */
+struct RenderParts {
+    static const unsigned int MAX_PARTS = 4;
+
+    unsigned int nr_parts;              //!< number of parts in use
+    unsigned int meshes[MAX_PARTS];     //!< mesh id per part
+    glm::vec3 colors[MAX_PARTS];        //!< color per part
+};
+
+/**
+ * @struct PieceStats
+ * @brief  game properties of a piece
+ */
+struct PieceStats {
+    unsigned int type;      //!< piece type
+    unsigned int owner;     //!< owning player
+    float health;           //!< remaining health
+    float strength;         //!< attack strength
+};
+
+#endif //_COMPONENTS_H
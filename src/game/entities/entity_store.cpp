@@ -0,0 +1,162 @@
+/**************************************************************************
+ *   entity_store.cpp  --  This file is part of Acardov.                  *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "game/entities/entity_store.h"
+
+EntityStore::EntityStore() :
+    nr_entities(0),
+    hash(0) {}
+
+/**
+ * @brief       reserve memory for a number of entities
+ *
+ * @param       capacity        number of entities
+ */
+void EntityStore::reserve(uint32_t capacity) {
+    this->generations.reserve(capacity);
+    this->free_slots.reserve(capacity);
+    this->alive.reserve(capacity);
+
+    this->transforms.reserve(capacity);
+    this->locations.reserve(capacity);
+    this->parts.reserve(capacity);
+    this->stats.reserve(capacity);
+
+    this->occupancy.reserve(capacity);
+}
+
+/**
+ * @brief       create an entity without any components
+ *
+ * @return      handle to the entity
+ */
+Entity EntityStore::create() {
+    uint32_t index;
+    if(this->free_slots.empty()) {
+        index = this->generations.size();
+        this->generations.push_back(0);
+        this->alive.push_back(true);
+    } else {
+        index = this->free_slots.back();
+        this->free_slots.pop_back();
+        this->alive[index] = true;
+    }
+
+    this->nr_entities++;
+
+    return this->get_handle(index);
+}
+
+/**
+ * @brief       create an entity with the components of an archetype
+ *
+ * @param       archetype       template of the components
+ * @param       owner           owning player
+ *
+ * @return      handle to the entity
+ */
+Entity EntityStore::spawn(const PieceArchetype& archetype, unsigned int owner) {
+    const Entity entity = this->create();
+
+    this->transforms.add(entity.index, archetype.transform);
+    this->parts.add(entity.index, archetype.parts);
+
+    PieceStats piece_stats = archetype.stats;
+    piece_stats.owner = owner;
+    this->set_stats(entity.index, piece_stats);
+
+    return entity;
+}
+
+/**
+ * @brief       destroy an entity and all of its components
+ *
+ * @param       entity          handle to the entity
+ */
+void EntityStore::destroy(Entity entity) {
+    if(!this->is_alive(entity)) {
+        return;
+    }
+
+    if(this->locations.has(entity.index)) {
+        this->hash ^= StateHash::piece_tile(entity.index, entity.generation, this->locations.get(entity.index).tile);
+    }
+    if(this->stats.has(entity.index)) {
+        this->hash ^= StateHash::piece_stats(entity.index, entity.generation, this->stats.get(entity.index));
+    }
+
+    this->transforms.remove(entity.index);
+    this->locations.remove(entity.index);
+    this->occupancy.remove(entity.index);
+    this->parts.remove(entity.index);
+    this->stats.remove(entity.index);
+
+    // invalidate all outstanding handles to this slot
+    this->generations[entity.index]++;
+    this->alive[entity.index] = false;
+    this->free_slots.push_back(entity.index);
+    this->nr_entities--;
+}
+
+/**
+ * @brief       set the tile location of an entity and update the occupancy index
+ *
+ * @param       entity          entity index
+ * @param       tile            tile id
+ */
+void EntityStore::set_location(uint32_t entity, unsigned int tile) {
+    const uint32_t generation = this->generations[entity];
+    if(this->locations.has(entity)) {
+        this->hash ^= StateHash::piece_tile(entity, generation, this->locations.get(entity).tile);
+    }
+    this->hash ^= StateHash::piece_tile(entity, generation, tile);
+
+    TileLocation location;
+    location.tile = tile;
+    this->locations.add(entity, location);
+    this->occupancy.insert(entity, tile);
+}
+
+/**
+ * @brief       set the stats of an entity
+ *
+ * @param       entity          entity index
+ * @param       piece_stats     new stats
+ */
+void EntityStore::set_stats(uint32_t entity, const PieceStats& piece_stats) {
+    const uint32_t generation = this->generations[entity];
+    if(this->stats.has(entity)) {
+        this->hash ^= StateHash::piece_stats(entity, generation, this->stats.get(entity));
+    }
+    this->hash ^= StateHash::piece_stats(entity, generation, piece_stats);
+
+    this->stats.add(entity, piece_stats);
+}
+
+/**
+ * @brief       destroy all entities
+ */
+void EntityStore::clear() {
+    for(uint32_t i=0; i<this->generations.size(); i++) {
+        if(this->alive[i]) {
+            this->destroy(this->get_handle(i));
+        }
+    }
+}
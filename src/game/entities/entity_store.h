@@ -0,0 +1,171 @@
+/**************************************************************************
+ *   entity_store.h  --  This file is part of Acardov.                    *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _ENTITY_STORE_H
+#define _ENTITY_STORE_H
+
+#include <vector>
+#include <cstdint>
+
+#include "game/entities/component_array.h"
+#include "game/entities/components.h"
+#include "game/entities/archetypes.h"
+#include "game/entities/tile_occupancy.h"
+#include "game/state_hash.h"
+
+/**
+ * @class EntityStore
+ * @brief Entities and their components, one packed array per component type
+ *
+ * Entities are slots that are recycled after destruction. A handle remains
+ * valid as long as the generation of its slot has not changed.
+ */
+class EntityStore {
+private:
+    std::vector<uint32_t> generations;      //!< current generation per slot
+    std::vector<uint32_t> free_slots;       //!< slots available for reuse
+    std::vector<bool> alive;                //!< whether a slot is in use
+    uint32_t nr_entities;                   //!< number of living entities
+    uint64_t hash;                          //!< Zobrist hash of the locations and stats
+
+    TileOccupancy occupancy;                //!< entities per tile
+
+public:
+    ComponentArray<Transform> transforms;       //!< world placement
+    ComponentArray<TileLocation> locations;     //!< tile locations
+    ComponentArray<RenderParts> parts;          //!< meshes to draw
+    ComponentArray<PieceStats> stats;           //!< game properties
+
+    EntityStore();
+
+    /**
+     * @brief       reserve memory for a number of entities
+     *
+     * @param       capacity        number of entities
+     */
+    void reserve(uint32_t capacity);
+
+    /**
+     * @brief       create an entity without any components
+     *
+     * @return      handle to the entity
+     */
+    Entity create();
+
+    /**
+     * @brief       create an entity with the components of an archetype
+     *
+     * The entity is not placed on a tile yet. No memory is allocated as long
+     * as the capacity reserved beforehand suffices.
+     *
+     * @param       archetype       template of the components
+     * @param       owner           owning player
+     *
+     * @return      handle to the entity
+     */
+    Entity spawn(const PieceArchetype& archetype, unsigned int owner);
+
+    /**
+     * @brief       destroy an entity and all of its components
+     *
+     * @param       entity          handle to the entity
+     */
+    void destroy(Entity entity);
+
+    /**
+     * @brief       destroy all entities
+     */
+    void clear();
+
+    /**
+     * @brief       set the tile location of an entity and update the occupancy index
+     *
+     * The location should only be changed through this function.
+     *
+     * @param       entity          entity index
+     * @param       tile            tile id
+     */
+    void set_location(uint32_t entity, unsigned int tile);
+
+    /**
+     * @brief       set the stats of an entity
+     *
+     * The stats should only be changed through this function, such that the
+     * hash remains up to date.
+     *
+     * @param       entity          entity index
+     * @param       piece_stats     new stats
+     */
+    void set_stats(uint32_t entity, const PieceStats& piece_stats);
+
+    /**
+     * @brief       get the hash of the locations and stats of all entities
+     */
+    inline uint64_t get_hash() const {
+        return this->hash;
+    }
+
+    /**
+     * @brief       get the index of the entities on every tile
+     */
+    inline const TileOccupancy& get_occupancy() const {
+        return this->occupancy;
+    }
+
+    /**
+     * @brief       check whether a handle refers to a living entity
+     *
+     * @param       entity          handle to the entity
+     *
+     * @return      whether the entity is alive
+     */
+    inline bool is_alive(Entity entity) const {
+        return entity.index < this->generations.size() &&
+               this->alive[entity.index] &&
+               this->generations[entity.index] == entity.generation;
+    }
+
+    /**
+     * @brief       get the handle of the entity living in a slot
+     *
+     * @param       index           slot of the entity
+     *
+     * @return      handle to the entity
+     */
+    inline Entity get_handle(uint32_t index) const {
+        Entity entity;
+        entity.index = index;
+        entity.generation = this->generations[index];
+        return entity;
+    }
+
+    inline uint32_t get_nr_entities() const {
+        return this->nr_entities;
+    }
+
+    /**
+     * @brief       get the number of slots (living and recyclable)
+     */
+    inline uint32_t get_nr_slots() const {
+        return this->generations.size();
+    }
+};
+
+#endif //_ENTITY_STORE_H
@@ -0,0 +1,275 @@
+/**************************************************************************
+ *   movement_system.cpp  --  This file is part of Acardov.               *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "game/entities/movement_system.h"
+
+#include <cmath>
+#include <algorithm>
+
+const uint32_t MovementSystem::INVALID;
+
+MovementSystem::MovementSystem() :
+    nr_movers(0) {}
+
+/**
+ * @brief       let a piece walk along a path of tiles
+ *
+ * @param       store           entity store
+ * @param       entity          handle of the piece
+ * @param       path            tiles to visit in order
+ * @param       speed           angular speed in radians per second
+ */
+void MovementSystem::move(EntityStore& store, Entity entity, const std::vector<unsigned int>& path, float speed) {
+    if(!store.is_alive(entity) || path.empty()) {
+        return;
+    }
+
+    uint32_t i = this->find(entity);
+    const bool is_moving = (i != INVALID);
+
+    if(!is_moving) {
+        this->grow();
+        i = this->nr_movers++;
+        this->entities[i] = entity;
+        if(entity.index >= this->lookup.size()) {
+            this->lookup.resize(entity.index + 1, INVALID);
+        }
+        this->lookup[entity.index] = i;
+    }
+
+    // store the path reversed, such that the next tile is popped from the back
+    this->paths[i].assign(path.rbegin(), path.rend());
+    this->speeds[i] = speed;
+
+    if(!is_moving && !this->next_segment(i, store.transforms.get(entity.index))) {
+        this->remove(i);
+    }
+}
+
+/**
+ * @brief       stop a piece at the end of its current segment
+ *
+ * @param       entity          handle of the piece
+ */
+void MovementSystem::stop(Entity entity) {
+    const uint32_t i = this->find(entity);
+    if(i != INVALID) {
+        this->paths[i].clear();
+    }
+}
+
+/**
+ * @brief       advance all movers
+ *
+ * @param       store           entity store
+ * @param       dt              elapsed time in seconds
+ */
+void MovementSystem::update(EntityStore& store, float dt) {
+    const uint32_t n = this->nr_movers;
+
+    // advance every mover along its arc; only the arrays of the movers are
+    // touched here, such that this loop can be vectorized
+    for(uint32_t i=0; i<n; i++) {
+        const float t = std::min(1.0f, this->progress[i] + this->rates[i] * dt);
+        this->progress[i] = t;
+
+        const float half = 0.5f * t * this->angles[i];
+        const float s = std::sin(half);
+        const float w = std::cos(half);
+        const float x = this->axis_x[i] * s;
+        const float y = this->axis_y[i] * s;
+        const float z = this->axis_z[i] * s;
+
+        // rotate the start position: v' = v + 2w (u x v) + 2 u x (u x v)
+        const float vx = this->start_x[i];
+        const float vy = this->start_y[i];
+        const float vz = this->start_z[i];
+        const float cx = 2.0f * (y * vz - z * vy);
+        const float cy = 2.0f * (z * vx - x * vz);
+        const float cz = 2.0f * (x * vy - y * vx);
+        this->pos_x[i] = vx + w * cx + (y * cz - z * cy);
+        this->pos_y[i] = vy + w * cy + (z * cx - x * cz);
+        this->pos_z[i] = vz + w * cz + (x * cy - y * cx);
+
+        // rotate the start orientation: r * q
+        const float qw = this->start_qw[i];
+        const float qx = this->start_qx[i];
+        const float qy = this->start_qy[i];
+        const float qz = this->start_qz[i];
+        this->rot_w[i] = w * qw - x * qx - y * qy - z * qz;
+        this->rot_x[i] = w * qx + x * qw + y * qz - z * qy;
+        this->rot_y[i] = w * qy - x * qz + y * qw + z * qx;
+        this->rot_z[i] = w * qz + x * qy - y * qx + z * qw;
+    }
+
+    // write the results to the transforms and handle arrivals
+    uint32_t i = 0;
+    while(i < this->nr_movers) {
+        const Entity entity = this->entities[i];
+        if(!store.is_alive(entity)) {
+            this->remove(i);
+            continue;
+        }
+
+        Transform& transform = store.transforms.get(entity.index);
+        transform.position = glm::vec3(this->pos_x[i], this->pos_y[i], this->pos_z[i]);
+        transform.rotation = glm::quat(this->rot_w[i], this->rot_x[i], this->rot_y[i], this->rot_z[i]);
+        transform.dirty = true;
+
+        if(this->progress[i] >= 1.0f) {
+            // snap onto the tile to prevent the accumulation of round-off errors
+            transform.position = Planet::get().get_tile(this->targets[i])->get_pos();
+            transform.rotation = glm::normalize(transform.rotation);
+            store.set_location(entity.index, this->targets[i]);
+
+            if(!this->next_segment(i, transform)) {
+                this->remove(i);
+                continue;
+            }
+        }
+
+        i++;
+    }
+}
+
+/**
+ * @brief       start the next segment of the path of a mover
+ *
+ * @param       i               mover id
+ * @param       transform       current placement of the piece
+ *
+ * @return      false when the path has been completed
+ */
+bool MovementSystem::next_segment(uint32_t i, const Transform& transform) {
+    const glm::vec3& a = transform.position;
+
+    while(!this->paths[i].empty()) {
+        const unsigned int tile = this->paths[i].back();
+        this->paths[i].pop_back();
+
+        const glm::vec3& b = Planet::get().get_tile(tile)->get_pos();
+        const float cos_angle = glm::dot(glm::normalize(a), glm::normalize(b));
+        const float angle = std::acos(std::max(-1.0f, std::min(1.0f, cos_angle)));
+        const glm::vec3 axis = glm::cross(a, b);
+        if(angle < 1e-6f || glm::length(axis) < 1e-6f) {
+            continue;   // already there (or no unique great circle)
+        }
+
+        const glm::vec3 u = glm::normalize(axis);
+        this->start_x[i] = a.x;
+        this->start_y[i] = a.y;
+        this->start_z[i] = a.z;
+        this->start_qw[i] = transform.rotation.w;
+        this->start_qx[i] = transform.rotation.x;
+        this->start_qy[i] = transform.rotation.y;
+        this->start_qz[i] = transform.rotation.z;
+        this->axis_x[i] = u.x;
+        this->axis_y[i] = u.y;
+        this->axis_z[i] = u.z;
+        this->angles[i] = angle;
+        this->rates[i] = this->speeds[i] / angle;
+        this->progress[i] = 0.0f;
+        this->targets[i] = tile;
+
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief       find the mover of an entity
+ *
+ * @return      mover id or INVALID when the entity is not moving
+ */
+uint32_t MovementSystem::find(Entity entity) const {
+    if(entity.index >= this->lookup.size()) {
+        return INVALID;
+    }
+
+    const uint32_t i = this->lookup[entity.index];
+    if(i == INVALID || this->entities[i] != entity) {
+        return INVALID;
+    }
+
+    return i;
+}
+
+/**
+ * @brief       remove a mover by moving the last one in its place
+ */
+void MovementSystem::remove(uint32_t i) {
+    const uint32_t last = this->nr_movers - 1;
+
+    // the slot of a destroyed entity may already be moving again under a new generation
+    if(this->lookup[this->entities[i].index] == i) {
+        this->lookup[this->entities[i].index] = INVALID;
+    }
+
+    if(i != last) {
+        std::vector<float>* arrays[] = {
+            &this->start_x, &this->start_y, &this->start_z,
+            &this->start_qw, &this->start_qx, &this->start_qy, &this->start_qz,
+            &this->axis_x, &this->axis_y, &this->axis_z,
+            &this->angles, &this->rates, &this->progress,
+            &this->pos_x, &this->pos_y, &this->pos_z,
+            &this->rot_w, &this->rot_x, &this->rot_y, &this->rot_z,
+            &this->speeds
+        };
+        for(std::vector<float>* array: arrays) {
+            (*array)[i] = (*array)[last];
+        }
+
+        this->entities[i] = this->entities[last];
+        this->targets[i] = this->targets[last];
+        this->paths[i].swap(this->paths[last]);    // keeps the capacity of both paths
+        this->lookup[this->entities[i].index] = i;
+    }
+
+    this->paths[last].clear();
+    this->nr_movers--;
+}
+
+/**
+ * @brief       make room for one more mover
+ */
+void MovementSystem::grow() {
+    if(this->nr_movers < this->entities.size()) {
+        return;
+    }
+
+    const size_t size = this->nr_movers + 1;
+    std::vector<float>* arrays[] = {
+        &this->start_x, &this->start_y, &this->start_z,
+        &this->start_qw, &this->start_qx, &this->start_qy, &this->start_qz,
+        &this->axis_x, &this->axis_y, &this->axis_z,
+        &this->angles, &this->rates, &this->progress,
+        &this->pos_x, &this->pos_y, &this->pos_z,
+        &this->rot_w, &this->rot_x, &this->rot_y, &this->rot_z,
+        &this->speeds
+    };
+    for(std::vector<float>* array: arrays) {
+        array->resize(size);
+    }
+
+    this->entities.resize(size);
+    this->targets.resize(size);
+    this->paths.resize(size);
+}
@@ -0,0 +1,145 @@
+/**************************************************************************
+ *   movement_system.h  --  This file is part of Acardov.                 *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _MOVEMENT_SYSTEM_H
+#define _MOVEMENT_SYSTEM_H
+
+#include <vector>
+#include <cstdint>
+
+#include "game/entities/entity_store.h"
+#include "game/terrain/planet.h"
+
+/**
+ * @class MovementSystem
+ * @brief Moves pieces over the planet along great-circle arcs
+ *
+ * A moving piece (mover) travels over a path of tiles one segment at a time.
+ * A segment from tile centre a to tile centre b is a rotation over an angle
+ * theta around the axis a x b; at progress t both the position and the
+ * orientation of the piece are rotated by the quaternion
+ *
+ *     r(t) = (cos(t theta / 2), sin(t theta / 2) * axis)
+ *
+ * which equals a slerp in between the orientation at a and at b. The state
+ * of all movers is kept in separate arrays (structure of arrays), such that
+ * a single tight loop advances all of them.
+ */
+class MovementSystem {
+private:
+    uint32_t nr_movers;                         //!< number of active movers
+
+    std::vector<Entity> entities;               //!< entity per mover
+    std::vector<uint32_t> lookup;               //!< mover per entity index
+
+    // current segment
+    std::vector<float> start_x, start_y, start_z;           //!< start position
+    std::vector<float> start_qw, start_qx, start_qy, start_qz; //!< start orientation
+    std::vector<float> axis_x, axis_y, axis_z;              //!< rotation axis
+    std::vector<float> angles;                              //!< arc angle
+    std::vector<float> rates;                               //!< progress per second
+    std::vector<float> progress;                            //!< progress in [0,1]
+
+    // result of the last pass
+    std::vector<float> pos_x, pos_y, pos_z;                 //!< current position
+    std::vector<float> rot_w, rot_x, rot_y, rot_z;          //!< current orientation
+
+    // remaining path
+    std::vector<std::vector<unsigned int> > paths;          //!< tiles left to visit (in reverse order)
+    std::vector<unsigned int> targets;                      //!< tile at the end of the current segment
+    std::vector<float> speeds;                              //!< angular speed in radians per second
+
+public:
+    MovementSystem();
+
+    /**
+     * @brief       let a piece walk along a path of tiles
+     *
+     * The path should start with a neighbour of the tile the piece is on;
+     * a piece that is already moving continues from the end of its current
+     * segment.
+     *
+     * @param       store           entity store
+     * @param       entity          handle of the piece
+     * @param       path            tiles to visit in order
+     * @param       speed           angular speed in radians per second
+     */
+    void move(EntityStore& store, Entity entity, const std::vector<unsigned int>& path, float speed);
+
+    /**
+     * @brief       stop a piece at the end of its current segment
+     *
+     * @param       entity          handle of the piece
+     */
+    void stop(Entity entity);
+
+    /**
+     * @brief       advance all movers
+     *
+     * @param       store           entity store
+     * @param       dt              elapsed time in seconds
+     */
+    void update(EntityStore& store, float dt);
+
+    /**
+     * @brief       check whether a piece is on its way
+     *
+     * @param       entity          handle of the piece
+     */
+    inline bool is_moving(Entity entity) const {
+        return this->find(entity) != INVALID;
+    }
+
+    inline uint32_t get_nr_movers() const {
+        return this->nr_movers;
+    }
+
+private:
+    /**
+     * @brief       start the next segment of the path of a mover
+     *
+     * @param       i               mover id
+     * @param       transform       current placement of the piece
+     *
+     * @return      false when the path has been completed
+     */
+    bool next_segment(uint32_t i, const Transform& transform);
+
+    /**
+     * @brief       find the mover of an entity
+     *
+     * @return      mover id or INVALID when the entity is not moving
+     */
+    uint32_t find(Entity entity) const;
+
+    static const uint32_t INVALID = 0xFFFFFFFF;
+
+    /**
+     * @brief       remove a mover by moving the last one in its place
+     */
+    void remove(uint32_t i);
+
+    /**
+     * @brief       make room for one more mover
+     */
+    void grow();
+};
+
+#endif //_MOVEMENT_SYSTEM_H
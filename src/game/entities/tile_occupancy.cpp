@@ -0,0 +1,106 @@
+/**************************************************************************
+ *   tile_occupancy.cpp  --  This file is part of Acardov.                *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "game/entities/tile_occupancy.h"
+
+const uint32_t TileOccupancy::INVALID;
+
+/**
+ * @brief       reserve memory for a number of entities
+ *
+ * @param       capacity        number of entities
+ */
+void TileOccupancy::reserve(uint32_t capacity) {
+    this->next.reserve(capacity);
+    this->prev.reserve(capacity);
+    this->tiles.reserve(capacity);
+}
+
+/**
+ * @brief       place an entity on a tile (removing it from its previous tile)
+ *
+ * @param       entity          entity index
+ * @param       tile            tile id
+ */
+void TileOccupancy::insert(uint32_t entity, uint32_t tile) {
+    if(entity >= this->tiles.size()) {
+        this->next.resize(entity + 1, INVALID);
+        this->prev.resize(entity + 1, INVALID);
+        this->tiles.resize(entity + 1, INVALID);
+    }
+    if(tile >= this->heads.size()) {
+        this->heads.resize(tile + 1, INVALID);
+        this->counts.resize(tile + 1, 0);
+    }
+
+    if(this->tiles[entity] == tile) {
+        return;
+    }
+    this->remove(entity);
+
+    // push the entity at the front of the list of the tile
+    const uint32_t head = this->heads[tile];
+    this->next[entity] = head;
+    this->prev[entity] = INVALID;
+    if(head != INVALID) {
+        this->prev[head] = entity;
+    }
+    this->heads[tile] = entity;
+
+    this->tiles[entity] = tile;
+    this->counts[tile]++;
+}
+
+/**
+ * @brief       remove an entity from its tile (if any)
+ *
+ * @param       entity          entity index
+ */
+void TileOccupancy::remove(uint32_t entity) {
+    const uint32_t tile = this->get_tile(entity);
+    if(tile == INVALID) {
+        return;
+    }
+
+    if(this->prev[entity] != INVALID) {
+        this->next[this->prev[entity]] = this->next[entity];
+    } else {
+        this->heads[tile] = this->next[entity];
+    }
+    if(this->next[entity] != INVALID) {
+        this->prev[this->next[entity]] = this->prev[entity];
+    }
+
+    this->next[entity] = INVALID;
+    this->prev[entity] = INVALID;
+    this->tiles[entity] = INVALID;
+    this->counts[tile]--;
+}
+
+/**
+ * @brief       remove all entities
+ */
+void TileOccupancy::clear() {
+    this->heads.clear();
+    this->counts.clear();
+    this->next.clear();
+    this->prev.clear();
+    this->tiles.clear();
+}
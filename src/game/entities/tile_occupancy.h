@@ -0,0 +1,112 @@
+/**************************************************************************
+ *   tile_occupancy.h  --  This file is part of Acardov.                  *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _TILE_OCCUPANCY_H
+#define _TILE_OCCUPANCY_H
+
+#include <vector>
+#include <cstdint>
+
+/**
+ * @class TileOccupancy
+ * @brief Index of the entities standing on every tile
+ *
+ * Every tile holds the head of a doubly linked list of entities; the links
+ * are stored in flat arrays indexed by entity. Inserting, removing and
+ * moving an entity are O(1), as are the occupancy checks, and listing the
+ * entities on a tile only visits those entities.
+ */
+class TileOccupancy {
+public:
+    static const uint32_t INVALID = 0xFFFFFFFF;
+
+private:
+    std::vector<uint32_t> heads;        //!< first entity per tile
+    std::vector<uint32_t> counts;       //!< number of entities per tile
+
+    std::vector<uint32_t> next;         //!< next entity on the same tile
+    std::vector<uint32_t> prev;         //!< previous entity on the same tile
+    std::vector<uint32_t> tiles;        //!< tile per entity (INVALID when not placed)
+
+public:
+    /**
+     * @brief       reserve memory for a number of entities
+     *
+     * @param       capacity        number of entities
+     */
+    void reserve(uint32_t capacity);
+
+    /**
+     * @brief       place an entity on a tile (removing it from its previous tile)
+     *
+     * @param       entity          entity index
+     * @param       tile            tile id
+     */
+    void insert(uint32_t entity, uint32_t tile);
+
+    /**
+     * @brief       remove an entity from its tile (if any)
+     *
+     * @param       entity          entity index
+     */
+    void remove(uint32_t entity);
+
+    /**
+     * @brief       remove all entities
+     */
+    void clear();
+
+    inline bool is_occupied(uint32_t tile) const {
+        return tile < this->counts.size() && this->counts[tile] != 0;
+    }
+
+    inline uint32_t get_count(uint32_t tile) const {
+        return tile < this->counts.size() ? this->counts[tile] : 0;
+    }
+
+    /**
+     * @brief       get the first entity on a tile
+     *
+     * @return      entity index or INVALID when the tile is empty
+     */
+    inline uint32_t get_first(uint32_t tile) const {
+        return tile < this->heads.size() ? this->heads[tile] : INVALID;
+    }
+
+    /**
+     * @brief       get the next entity on the same tile
+     *
+     * @return      entity index or INVALID at the end of the list
+     */
+    inline uint32_t get_next(uint32_t entity) const {
+        return this->next[entity];
+    }
+
+    /**
+     * @brief       get the tile of an entity
+     *
+     * @return      tile id or INVALID when the entity is not placed
+     */
+    inline uint32_t get_tile(uint32_t entity) const {
+        return entity < this->tiles.size() ? this->tiles[entity] : INVALID;
+    }
+};
+
+#endif //_TILE_OCCUPANCY_H
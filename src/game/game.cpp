@@ -19,65 +19,342 @@
  **************************************************************************/
 
 #include "game.h"
+#include "core/settings.h"
 
-Game::Game() {
+Game::Game() :
+    nr_updates(0),
+    ai_turn(1.0),
+    ai_accumulator(0.0),
+    flag_ai(true),
+    flag_autosave(true),
+    recording_start(0) {
     Planet::get();
 
-    this->meshes.emplace_back(std::unique_ptr<Mesh>(new Mesh("assets/models/piece_base_hexagon.obj")));
-    this->meshes.emplace_back(std::unique_ptr<Mesh>(new Mesh("assets/models/piece_base_circle.obj")));
-    this->meshes.emplace_back(std::unique_ptr<Mesh>(new Mesh("assets/models/piece_gears.obj")));
-    this->meshes.emplace_back(std::unique_ptr<Mesh>(new Mesh("assets/models/piece_cube.obj")));
+    // player 0 means that there is no computer opponent
+    const unsigned int ai_player = Settings::get().get_uint_from_keyword("settings.ai.player");
+    if(ai_player != 0) {
+        this->ai = std::unique_ptr<AIPlayer>(new AIPlayer(ai_player,
+                                                          Planet::get().get_range(),
+                                                          Settings::get().get_float_from_keyword("settings.ai.budget"),
+                                                          Settings::get().get_uint_from_keyword("settings.ai.depth"),
+                                                          Settings::get().get_uint_from_keyword("settings.ai.rollouts")));
+        this->ai_turn = Settings::get().get_float_from_keyword("settings.ai.turn");
+    }
+
+    // the meshes and shaders are only required for drawing
+    if(!Headless::get().is_enabled()) {
+        this->load_graphics();
+    }
+
+    const Archetypes& archetypes = Archetypes::get();
+    this->add_pieces({86, 200, 12}, archetypes.find("engineer"), 1);
+    this->add_pieces({88, 201, 13}, archetypes.find("soldier"), 2);
+}
+
+void Game::load_graphics() {
+    // the mesh ids of the archetypes are the positions in this list
+    for(const std::string& filename: Archetypes::get().get_mesh_files()) {
+        this->meshes.emplace_back(std::unique_ptr<Mesh>(new Mesh(filename)));
+    }
 
     this->shader = std::unique_ptr<Shader>(new Shader("assets/shaders/piece"));
     this->shader->add_attribute(ShaderAttribute::POSITION, "position");
     this->shader->add_attribute(ShaderAttribute::NORMAL, "normal");
-    this->shader->add_uniform(ShaderUniform::MAT4, "mvp", 1);
-    this->shader->add_uniform(ShaderUniform::MAT4, "view", 1);
-    this->shader->add_uniform(ShaderUniform::VEC3, "light", 1);
-    this->shader->add_uniform(ShaderUniform::VEC3, "color", 1);
+    this->shader->add_attribute(ShaderAttribute::COLOR, "color");
+    this->shader->add_attribute(ShaderAttribute::MATRIX, "model");
 
     this->meshes[0]->load_vao();
     this->shader->bind_uniforms_and_attributes();
-    glBindVertexArray(0);
-
-    this->add_piece(86, 0);
-    this->add_piece(200, 0);
-    this->add_piece(12, 0);
-    this->add_piece(88, 1);
-    this->add_piece(201, 1);
-    this->add_piece(13, 1);
+    GLState::get().bind_vertex_array(0);
 }
 
 void Game::draw() {
     Planet::get().draw();
 
-    this->shader->link_shader();
+    // the camera and the light are taken from the per-frame uniform block
+    // collect the instances per mesh and draw every mesh at once
+    this->update_transforms();
+    for(uint32_t i=0; i<this->entities.parts.size(); i++) {
+        const RenderParts& parts = this->entities.parts[i];
+        const glm::mat4& model = this->entities.transforms.get(this->entities.parts.get_entity(i)).model;
 
-    for(auto& piece: pieces) {
-        piece.draw();
+        for(unsigned int j=0; j<parts.nr_parts; j++) {
+            this->meshes[parts.meshes[j]]->add_instance(model, parts.colors[j]);
+        }
     }
 
-    this->shader->unlink_shader();
+    for(auto& mesh: this->meshes) {
+        mesh->submit_instances(this->shader->get_program());
+    }
 }
 
 
 void Game::update(double dt) {
+    this->execute_commands();
+
     Planet::get().update(dt);
+    this->movement.update(this->entities, dt);
+
+    if(this->flag_autosave) {
+        SaveSnapshot* snapshot = SaveGame::get().update(dt);
+        if(snapshot != NULL) {
+            this->capture(snapshot);
+            SaveGame::get().commit();
+        }
+    }
+
+    // the moves of the AI are executed (and recorded) at the start of the next update
+    if(this->ai && this->flag_ai) {
+        this->ai_accumulator += dt;
+        if(this->ai_accumulator >= this->ai_turn) {
+            this->ai_accumulator -= this->ai_turn;
+
+            Planet& planet = Planet::get();
+            this->ai->play(this->entities, this->movement,
+                           planet.get_simulation().get_state(), planet.get_territories(),
+                           this->get_hash(), &this->pending);
+        }
+    }
+
+    this->nr_updates++;
+
+    if(this->recording && (this->nr_updates - this->recording_start) % this->recording->get_checksum_interval() == 0) {
+        this->recording->add_checksum(this->get_hash());
+    }
+}
+
+void Game::submit(const Command& command) {
+    this->pending.push_back(command);
+}
+
+bool Game::start_recording(const std::string& filename, double dt) {
+    if(this->recording) {
+        this->stop_recording();
+    }
+
+    // start from a state that a replay can reproduce exactly
+    SaveSnapshot snapshot;
+    this->capture(&snapshot);
+    if(!SaveGame::write(filename + ".sav", snapshot, NULL)) {
+        return false;
+    }
+    this->restore(snapshot);
+
+    this->recording = std::unique_ptr<CommandLog>(new CommandLog());
+    this->recording->clear(dt);
+    this->recording_filename = filename;
+    this->recording_start = this->nr_updates;
+
+    return true;
+}
+
+bool Game::stop_recording() {
+    if(!this->recording) {
+        return false;
+    }
+
+    this->recording->set_nr_updates(this->nr_updates - this->recording_start);
+    const bool result = this->recording->write(this->recording_filename);
+    if(result) {
+        std::cout << "Recorded " << this->recording->get_nr_commands() << " commands over "
+                  << this->recording->get_nr_updates() << " updates to " << this->recording_filename << std::endl;
+    }
+
+    this->recording.reset();
+    return result;
 }
 
-void Game::add_piece(unsigned int tile_id, unsigned int type) {
-    this->pieces.push_back(Piece(this->shader.get()));
+void Game::capture_state(GameState* state) {
+    Planet& planet = Planet::get();
+    planet.synchronize();
 
-    switch(type) {
-        case 0:
-            this->pieces.back().add_mesh(this->meshes[0].get(), glm::vec3(0.5f, 0.5f, 0.5f));
-            this->pieces.back().add_mesh(this->meshes[2].get(), glm::vec3(1.0f, 0.5f, 0.5f));
+    state->nr_updates = this->nr_updates;
+    state->accumulator = planet.get_simulation().get_accumulator();
+    this->capture(&state->world);
+    state->entities = this->entities;
+    state->movement = this->movement;
+}
+
+void Game::restore_state(const GameState& state) {
+    Planet& planet = Planet::get();
+    planet.restore(&state.world.fields[0], &state.world.owners[0], state.world.tick);
+    planet.get_simulation().set_accumulator(state.accumulator);
+
+    this->nr_updates = state.nr_updates;
+    this->entities = state.entities;
+    this->movement = state.movement;
+    this->pending.clear();
+}
+
+void Game::execute_commands() {
+    for(const Command& command: this->pending) {
+        if(this->recording) {
+            this->recording->append(this->nr_updates - this->recording_start, command);
+        }
+        this->execute(command);
+    }
+    this->pending.clear();
+}
+
+void Game::execute(const Command& command) {
+    Planet& planet = Planet::get();
+
+    switch(command.type) {
+        case Command::ADD_PIECE:
+            if(command.tile < planet.get_nr_tiles() && command.value < Archetypes::get().get_nr_archetypes()) {
+                this->add_piece(command.tile, command.value, command.owner);
+            }
+        break;
+        case Command::SET_PIECE_TILE:
+            if(this->entities.is_alive(command.piece) && command.tile < planet.get_nr_tiles()) {
+                this->set_piece_tile(command.piece, command.tile);
+            }
+        break;
+        case Command::MOVE_PIECE:
+            for(unsigned int tile: command.path) {
+                if(tile >= planet.get_nr_tiles()) {
+                    return;
+                }
+            }
+            if(this->entities.is_alive(command.piece)) {
+                this->move_piece(command.piece, command.path, command.amount);
+            }
         break;
-        case 1:
-            this->pieces.back().add_mesh(this->meshes[1].get(), hex2col("f7a147"));
-            this->pieces.back().add_mesh(this->meshes[3].get(), glm::vec3(0.0f, 0.0f, 0.0f));
+        case Command::REMOVE_PIECE:
+            if(this->entities.is_alive(command.piece)) {
+                this->remove_piece(command.piece);
+            }
         break;
+        case Command::SET_TILE_OWNER:
+            if(command.tile < planet.get_nr_tiles()) {
+                planet.set_tile_owner(command.tile, command.value);
+            }
+        break;
+        case Command::SET_TILE_VALUE:
+            if(command.tile < planet.get_nr_tiles() && command.value < TileState::NR_FIELDS) {
+                planet.get_simulation().set_value(command.value, command.tile, command.amount);
+            }
+        break;
+        default:
+            std::cerr << "[ERROR] Unknown command type " << command.type << std::endl;
+        break;
+    }
+}
+
+Entity Game::add_piece(unsigned int tile_id, unsigned int type, unsigned int owner) {
+    const Archetypes& archetypes = Archetypes::get();
+    if(type >= archetypes.get_nr_archetypes()) {
+        std::cerr << "[ERROR] Unknown piece type " << type << std::endl;
+        Entity none;
+        none.index = 0xFFFFFFFF;
+        none.generation = 0;
+        return none;
+    }
+
+    const Entity piece = this->entities.spawn(archetypes.get_archetype(type), owner);
+    this->set_piece_tile(piece, tile_id);
+
+    return piece;
+}
+
+void Game::add_pieces(const std::vector<unsigned int>& tiles, unsigned int type, unsigned int owner) {
+    this->entities.reserve(this->entities.get_nr_slots() + tiles.size());
+
+    for(unsigned int tile_id: tiles) {
+        this->add_piece(tile_id, type, owner);
+    }
+}
+
+void Game::set_piece_tile(Entity piece, unsigned int tile_id) {
+    const glm::vec3& pos = Planet::get().get_tile(tile_id)->get_pos();
+
+    this->entities.set_location(piece.index, tile_id);
+
+    // stand upright on the tile
+    Transform& transform = this->entities.transforms.get(piece.index);
+    transform.position = pos;
+    transform.rotation = glm::rotation(glm::vec3(0,1,0), glm::normalize(pos));
+    transform.dirty = true;
+}
+
+void Game::move_piece(Entity piece, const std::vector<unsigned int>& path, float speed) {
+    this->movement.move(this->entities, piece, path, speed);
+}
+
+void Game::remove_piece(Entity piece) {
+    this->movement.stop(piece);
+    this->entities.destroy(piece);
+}
+
+void Game::capture(SaveSnapshot* snapshot) const {
+    Planet& planet = Planet::get();
+    const TileState& state = planet.get_simulation().get_state();
+    const unsigned int nr_tiles = state.get_nr_tiles();
+
+    snapshot->tick = planet.get_simulation().get_nr_ticks();
+    snapshot->nr_tiles = nr_tiles;
+    snapshot->nr_fields = TileState::NR_FIELDS;
+
+    snapshot->fields.resize(TileState::NR_FIELDS * nr_tiles);
+    std::copy(state.get_field(0), state.get_field(0) + TileState::NR_FIELDS * nr_tiles, snapshot->fields.begin());
+
+    snapshot->owners.resize(nr_tiles);
+    for(unsigned int i=0; i<nr_tiles; i++) {
+        snapshot->owners[i] = planet.get_territories().get_key(i);
+    }
+
+    snapshot->pieces.resize(this->entities.stats.size());
+    for(uint32_t i=0; i<this->entities.stats.size(); i++) {
+        const uint32_t entity = this->entities.stats.get_entity(i);
+        snapshot->pieces[i].tile = this->entities.locations.get(entity).tile;
+        snapshot->pieces[i].type = this->entities.stats[i].type;
+        snapshot->pieces[i].owner = this->entities.stats[i].owner;
+    }
+}
+
+void Game::restore(const SaveSnapshot& snapshot) {
+    Planet::get().restore(&snapshot.fields[0], &snapshot.owners[0], snapshot.tick);
+
+    // start from fresh entity slots, such that the same snapshot always yields the same handles
+    this->entities = EntityStore();
+    this->movement = MovementSystem();
+    this->pending.clear();
+    for(const SavePiece& piece: snapshot.pieces) {
+        this->add_piece(piece.tile, piece.type, piece.owner);
+    }
+}
+
+void Game::update_transforms() {
+    for(uint32_t i=0; i<this->entities.transforms.size(); i++) {
+        Transform& transform = this->entities.transforms[i];
+        if(!transform.dirty) {
+            continue;
+        }
+
+        transform.model = glm::translate(transform.position) *
+                          glm::mat4_cast(transform.rotation) *
+                          glm::scale(glm::vec3(transform.scale));
+        transform.dirty = false;
+    }
+}
+
+bool Game::save(const std::string& filename) const {
+    SaveSnapshot snapshot;
+    this->capture(&snapshot);
+    return SaveGame::write(filename, snapshot, NULL);
+}
+
+bool Game::load(const std::string& filename, const std::string& delta) {
+    SaveSnapshot snapshot;
+    if(!SaveGame::load(filename, delta, &snapshot)) {
+        return false;
+    }
+
+    if(snapshot.nr_tiles != Planet::get().get_nr_tiles() || snapshot.nr_fields != TileState::NR_FIELDS) {
+        std::cerr << "[ERROR] Save file " << filename << " does not match the current world" << std::endl;
+        return false;
     }
 
-    this->pieces.back().set_tile(Planet::get().get_tile(tile_id));
+    this->restore(snapshot);
+    return true;
 }
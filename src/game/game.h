@@ -25,13 +25,48 @@
 #include "models/mesh.h"
 #include "core/shader.h"
 #include "core/light.h"
-#include "game/piece.h"
+#include "game/entities/entity_store.h"
+#include "game/entities/movement_system.h"
+#include "game/save_game.h"
+#include "game/command.h"
+#include "game/command_log.h"
+#include "game/ai/ai_player.h"
+
+/**
+ * @struct GameState
+ * @brief  complete copy of the state of the game
+ *
+ * Unlike a save snapshot, this also holds the entity slots and the pieces in
+ * motion, such that continuing from a restored state gives exactly the same
+ * result as continuing from the original one.
+ */
+struct GameState {
+    uint64_t nr_updates;        //!< number of game updates
+    double accumulator;         //!< simulation time not yet consumed by ticks
+    SaveSnapshot world;         //!< tile fields and owners
+    EntityStore entities;       //!< entities and their components
+    MovementSystem movement;    //!< pieces in motion
+};
 
 class Game {
 private:
     std::vector<std::unique_ptr<Mesh> > meshes;
     std::unique_ptr<Shader> shader;
-    std::vector<Piece> pieces;
+    EntityStore entities;
+    MovementSystem movement;
+
+    uint64_t nr_updates;                        //!< number of game updates
+    std::vector<Command> pending;               //!< commands for the next update
+
+    std::unique_ptr<AIPlayer> ai;               //!< computer opponent (NULL when there is none)
+    double ai_turn;                             //!< time in between the turns of the AI in seconds
+    double ai_accumulator;                      //!< time since the last turn of the AI
+    bool flag_ai;                               //!< whether the AI is allowed to play
+    bool flag_autosave;                         //!< whether the game is saved periodically
+
+    std::unique_ptr<CommandLog> recording;      //!< commands recorded so far (NULL when not recording)
+    std::string recording_filename;             //!< path of the command log
+    uint64_t recording_start;                   //!< update at which the recording started
 
 public:
     /**
@@ -50,11 +85,197 @@ public:
 
     void update(double dt);
 
-    void add_piece(unsigned int tile_id, unsigned int type);
+    /**
+     * @brief       issue a command, executed at the start of the next update
+     *
+     * All player and AI actions should go through here, such that they end
+     * up in the recording.
+     *
+     * @param       command         the command
+     */
+    void submit(const Command& command);
+
+    /**
+     * @brief       start recording all commands
+     *
+     * The game is reset to its saved state, which is written next to the
+     * log as <filename>.sav; a replay starts from that save.
+     *
+     * @param       filename        path to the command log
+     * @param       dt              game time per update in seconds
+     *
+     * @return      whether the recording could be started
+     */
+    bool start_recording(const std::string& filename, double dt);
+
+    /**
+     * @brief       stop recording and write the command log
+     *
+     * @return      whether the log was written
+     */
+    bool stop_recording();
+
+    inline bool is_recording() const {
+        return (bool)this->recording;
+    }
+
+    /**
+     * @brief       let the AI play or not, e.g. during a replay its moves come from the log
+     */
+    inline void set_ai_enabled(bool enabled) {
+        this->flag_ai = enabled;
+    }
+
+    /**
+     * @brief       let the moves of the AI depend on the state of the game only, e.g. for reproducible headless runs
+     */
+    inline void set_ai_deterministic(bool deterministic) {
+        if(this->ai) {
+            this->ai->set_deterministic(deterministic);
+        }
+    }
+
+    /**
+     * @brief       save the game periodically or not, e.g. benchmarks and replays must not overwrite the autosave
+     */
+    inline void set_autosave_enabled(bool enabled) {
+        this->flag_autosave = enabled;
+    }
+
+    /**
+     * @brief       get the hash of the tile owners and the pieces, maintained incrementally
+     */
+    inline uint64_t get_hash() const {
+        return Planet::get().get_hash() ^ this->entities.get_hash();
+    }
+
+    inline uint64_t get_nr_updates() const {
+        return this->nr_updates;
+    }
+
+    /**
+     * @brief       copy the complete state of the game
+     *
+     * @param       state           state to write to
+     */
+    void capture_state(GameState* state);
+
+    /**
+     * @brief       replace the complete state of the game
+     *
+     * @param       state           state to read from
+     */
+    void restore_state(const GameState& state);
+
+    /**
+     * @brief       place a new piece on a tile
+     *
+     * @param       tile_id         tile id
+     * @param       type            piece type (index of its archetype)
+     * @param       owner           owning player
+     *
+     * @return      handle to the piece (not alive when the type is unknown)
+     */
+    Entity add_piece(unsigned int tile_id, unsigned int type, unsigned int owner);
+
+    /**
+     * @brief       place new pieces of the same type on a number of tiles
+     *
+     * Memory for all pieces is reserved up front, such that spawning does
+     * not allocate per piece.
+     *
+     * @param       tiles           tile id per piece
+     * @param       type            piece type (index of its archetype)
+     * @param       owner           owning player
+     */
+    void add_pieces(const std::vector<unsigned int>& tiles, unsigned int type, unsigned int owner);
+
+    /**
+     * @brief       move a piece onto a tile
+     *
+     * @param       piece           handle to the piece
+     * @param       tile_id         tile id
+     */
+    void set_piece_tile(Entity piece, unsigned int tile_id);
+
+    /**
+     * @brief       let a piece walk along a path of tiles
+     *
+     * @param       piece           handle to the piece
+     * @param       path            tiles to visit in order
+     * @param       speed           angular speed in radians per second
+     */
+    void move_piece(Entity piece, const std::vector<unsigned int>& path, float speed);
+
+    /**
+     * @brief       remove a piece from the game
+     *
+     * @param       piece           handle to the piece
+     */
+    void remove_piece(Entity piece);
+
+    inline const EntityStore& get_entities() const {
+        return this->entities;
+    }
+
+    /**
+     * @brief       copy the persistent state of the game into a snapshot
+     *
+     * @param       snapshot        snapshot to write to
+     */
+    void capture(SaveSnapshot* snapshot) const;
+
+    /**
+     * @brief       replace the state of the game by a snapshot
+     *
+     * @param       snapshot        snapshot to read from
+     */
+    void restore(const SaveSnapshot& snapshot);
+
+    /**
+     * @brief       write the game to a save file
+     *
+     * @param       filename        path to the file
+     *
+     * @return      whether the game was saved
+     */
+    bool save(const std::string& filename) const;
+
+    /**
+     * @brief       load the game from a save file
+     *
+     * @param       filename        path to the full save
+     * @param       delta           path to a delta save on top of it (empty for none)
+     *
+     * @return      whether the game was loaded
+     */
+    bool load(const std::string& filename, const std::string& delta);
 
 private:
     Game();
 
+    /**
+     * @brief       load the piece meshes and shader (skipped when headless)
+     */
+    void load_graphics();
+
+    /**
+     * @brief       execute (and record) the pending commands
+     */
+    void execute_commands();
+
+    /**
+     * @brief       execute a single command
+     *
+     * @param       command         the command
+     */
+    void execute(const Command& command);
+
+    /**
+     * @brief       rebuild the model matrices of the transforms that changed
+     */
+    void update_transforms();
+
     // Singleton pattern
     Game(Game const&)          = delete;
     void operator=(Game const&)  = delete;
@@ -0,0 +1,160 @@
+/**************************************************************************
+ *   replay.cpp  --  This file is part of Acardov.                        *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "game/replay.h"
+
+#include <iostream>
+#include <algorithm>
+
+/**
+ * @brief       constructor
+ *
+ * @param       _keyframe_interval      updates in between keyframes
+ */
+Replay::Replay(unsigned int _keyframe_interval) :
+    position(0),
+    cursor(0),
+    cursor_update(0),
+    next_pos(0),
+    command_update(0),
+    flag_command(false),
+    desync_update(0),
+    keyframe_interval(std::max(1u, _keyframe_interval)) {}
+
+/**
+ * @brief       load a command log and reset the game to its start
+ *
+ * @param       filename        path to the command log
+ *
+ * @return      whether the replay could be loaded
+ */
+bool Replay::load(const std::string& filename) {
+    if(!this->log.read(filename)) {
+        return false;
+    }
+
+    // all moves, including those of the AI, come from the log
+    Game& game = Game::get();
+    game.set_ai_enabled(false);
+    game.set_autosave_enabled(false);
+    if(game.is_recording()) {
+        game.stop_recording();
+    }
+    if(!game.load(filename + ".sav", "")) {
+        return false;
+    }
+
+    this->position = 0;
+    this->desync_update = 0;
+    this->next_pos = 0;
+    this->command_update = 0;
+    this->fetch();
+
+    this->keyframes.clear();
+    this->add_keyframe();
+
+    return true;
+}
+
+/**
+ * @brief       play a single update
+ */
+void Replay::advance() {
+    if(this->is_finished()) {
+        return;
+    }
+
+    Game& game = Game::get();
+    while(this->flag_command && this->command_update == this->position) {
+        game.submit(this->command);
+        this->fetch();
+    }
+    game.update(this->log.get_dt());
+    this->position++;
+
+    const unsigned int interval = this->log.get_checksum_interval();
+    if(this->position % interval == 0) {
+        const uint64_t k = this->position / interval - 1;
+        if(k < this->log.get_nr_checksums() && this->log.get_checksum(k) != game.get_hash() && this->desync_update == 0) {
+            std::cerr << "[ERROR] Replay diverges from the recording at update " << this->position << std::endl;
+            this->desync_update = this->position;
+        }
+    }
+
+    if(this->position % this->keyframe_interval == 0 &&
+       this->position / this->keyframe_interval == this->keyframes.size()) {
+        this->add_keyframe();
+    }
+}
+
+/**
+ * @brief       bring the game to the state after a number of updates
+ *
+ * @param       update          number of updates since the start of the recording
+ */
+void Replay::seek(uint64_t update) {
+    update = std::min(update, this->log.get_nr_updates());
+
+    // the nearest keyframe at or before the target
+    const size_t k = std::min<size_t>(update / this->keyframe_interval, this->keyframes.size() - 1);
+    const uint64_t keyframe_update = (uint64_t)k * this->keyframe_interval;
+    if(update < this->position || keyframe_update > this->position) {
+        this->restore_keyframe(k);
+    }
+
+    while(this->position < update) {
+        this->advance();
+    }
+}
+
+/**
+ * @brief       decode the next command of the log
+ */
+void Replay::fetch() {
+    this->cursor = this->next_pos;
+    this->cursor_update = this->command_update;
+    this->flag_command = this->log.decode(&this->next_pos, &this->command_update, &this->command);
+}
+
+/**
+ * @brief       store a keyframe of the current state
+ */
+void Replay::add_keyframe() {
+    Keyframe* keyframe = new Keyframe();
+    Game::get().capture_state(&keyframe->state);
+    keyframe->cursor = this->cursor;
+    keyframe->cursor_update = this->cursor_update;
+    this->keyframes.emplace_back(keyframe);
+}
+
+/**
+ * @brief       continue from a keyframe
+ *
+ * @param       k               keyframe id
+ */
+void Replay::restore_keyframe(size_t k) {
+    const Keyframe& keyframe = *this->keyframes[k];
+    Game::get().restore_state(keyframe.state);
+
+    this->position = (uint64_t)k * this->keyframe_interval;
+    this->next_pos = keyframe.cursor;
+    this->command_update = keyframe.cursor_update;
+    this->fetch();
+}
@@ -0,0 +1,145 @@
+/**************************************************************************
+ *   replay.h  --  This file is part of Acardov.                          *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _REPLAY_H
+#define _REPLAY_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "game/game.h"
+
+/**
+ * @class Replay
+ * @brief Plays back a recorded command log
+ *
+ * The game is restored to the save that was written when the recording
+ * started, after which the recorded commands are fed to the game at the
+ * updates they were issued in. Since the game is deterministic, this
+ * reproduces the match exactly. Playback does not render anything, so it
+ * runs at the speed of the simulation. The hash of the game is compared to
+ * the checksums in the log, which reveals any non-determinism.
+ *
+ * While playing, a copy of the complete game state (keyframe) is kept every
+ * few updates. Seeking backwards, or forward past a known keyframe, starts
+ * from the nearest keyframe instead of from the beginning.
+ */
+class Replay {
+private:
+    /**
+     * @struct Keyframe
+     * @brief  game state and log position at a multiple of the keyframe interval
+     */
+    struct Keyframe {
+        GameState state;            //!< complete game state
+        size_t cursor;              //!< position of the next command in the log
+        uint64_t cursor_update;     //!< update of the command before it
+    };
+
+    CommandLog log;                                 //!< recorded commands
+    uint64_t position;                              //!< number of updates played
+
+    // decoder position; the next command is already decoded
+    size_t cursor;                                  //!< position of the next command in the log
+    uint64_t cursor_update;                         //!< update of the command before it
+    size_t next_pos;                                //!< position after the next command
+    uint64_t command_update;                        //!< update of the next command
+    Command command;                                //!< next command
+    bool flag_command;                              //!< whether there is a next command
+
+    uint64_t desync_update;                         //!< first update whose checksum did not match (0 if none)
+
+    unsigned int keyframe_interval;                 //!< updates in between keyframes
+    std::vector<std::unique_ptr<Keyframe> > keyframes;  //!< keyframe k is at update k * interval
+
+public:
+    /**
+     * @brief       constructor
+     *
+     * @param       _keyframe_interval      updates in between keyframes
+     */
+    Replay(unsigned int _keyframe_interval = 600);
+
+    /**
+     * @brief       load a command log and reset the game to its start
+     *
+     * @param       filename        path to the command log
+     *
+     * @return      whether the replay could be loaded
+     */
+    bool load(const std::string& filename);
+
+    /**
+     * @brief       play a single update
+     */
+    void advance();
+
+    /**
+     * @brief       bring the game to the state after a number of updates
+     *
+     * @param       update          number of updates since the start of the recording
+     */
+    void seek(uint64_t update);
+
+    inline bool is_finished() const {
+        return this->position >= this->log.get_nr_updates();
+    }
+
+    /**
+     * @brief       get the first update at which the replay diverged from the recording
+     *
+     * @return      update number, 0 when the replay matches the recording so far
+     */
+    inline uint64_t get_desync_update() const {
+        return this->desync_update;
+    }
+
+    inline uint64_t get_position() const {
+        return this->position;
+    }
+
+    inline const CommandLog& get_log() const {
+        return this->log;
+    }
+
+private:
+    /**
+     * @brief       decode the next command of the log
+     */
+    void fetch();
+
+    /**
+     * @brief       store a keyframe of the current state
+     */
+    void add_keyframe();
+
+    /**
+     * @brief       continue from a keyframe
+     *
+     * @param       k               keyframe id
+     */
+    void restore_keyframe(size_t k);
+
+    Replay(Replay const&)               = delete;
+    void operator=(Replay const&)       = delete;
+};
+
+#endif //_REPLAY_H
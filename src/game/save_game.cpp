@@ -0,0 +1,490 @@
+/**************************************************************************
+ *   save_game.cpp  --  This file is part of Acardov.                     *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "game/save_game.h"
+
+#include <iostream>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+
+#include "core/asset_manager.h"
+#include "core/settings.h"
+
+static const char SAVE_MAGIC[8] = {'A', 'C', 'A', 'R', 'D', 'O', 'V', '\0'};
+static const uint32_t SAVE_VERSION = 2;
+static const uint32_t SAVE_MAX_FIELDS = 256;   //!< bound on the number of fields, such that the section sizes cannot overflow
+
+/**
+ * @brief       round a byte offset up to a multiple of eight
+ */
+static inline uint64_t align_offset(uint64_t offset) {
+    return (offset + 7) & ~((uint64_t)7);
+}
+
+SaveFile::SaveFile() :
+    fd(-1),
+    data(MAP_FAILED),
+    size(0),
+    header(NULL),
+    tile_ids(NULL),
+    fields(NULL),
+    owners(NULL),
+    piece_ids(NULL),
+    pieces(NULL) {}
+
+/**
+ * @brief       map a save file and validate its header
+ *
+ * @param       filename        path to the file
+ *
+ * @return      whether the file is a valid save file
+ */
+bool SaveFile::open(const std::string& filename) {
+    this->close();
+
+    this->fd = ::open(filename.c_str(), O_RDONLY);
+    if(this->fd < 0) {
+        std::cerr << "[ERROR] Cannot open save file " << filename << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if(fstat(this->fd, &st) != 0 || (size_t)st.st_size < sizeof(SaveHeader)) {
+        std::cerr << "[ERROR] Save file " << filename << " is truncated" << std::endl;
+        this->close();
+        return false;
+    }
+
+    this->size = st.st_size;
+    this->data = mmap(NULL, this->size, PROT_READ, MAP_PRIVATE, this->fd, 0);
+    if(this->data == MAP_FAILED) {
+        std::cerr << "[ERROR] Cannot map save file " << filename << std::endl;
+        this->close();
+        return false;
+    }
+
+    // resolve the sections
+    const char* base = (const char*)this->data;
+    this->header = (const SaveHeader*)base;
+
+    const SaveHeader& h = *this->header;
+    const bool is_delta = (h.type == SaveHeader::DELTA);
+
+    // bound the counts before multiplying them
+    if(h.nr_fields > SAVE_MAX_FIELDS ||
+       h.nr_tile_entries > this->size / sizeof(uint32_t) ||
+       h.nr_piece_entries > this->size / sizeof(SavePiece)) {
+        std::cerr << "[ERROR] " << filename << " is not a valid save file (version " << SAVE_VERSION << ")" << std::endl;
+        this->close();
+        return false;
+    }
+
+    const uint64_t sections[5][2] = {
+        {h.offset_tile_ids,  is_delta ? h.nr_tile_entries * sizeof(uint32_t) : 0},
+        {h.offset_fields,    (uint64_t)h.nr_fields * h.nr_tile_entries * sizeof(float)},
+        {h.offset_owners,    h.nr_tile_entries * sizeof(uint32_t)},
+        {h.offset_piece_ids, is_delta ? h.nr_piece_entries * sizeof(uint32_t) : 0},
+        {h.offset_pieces,    h.nr_piece_entries * sizeof(SavePiece)}
+    };
+
+    bool valid = std::memcmp(h.magic, SAVE_MAGIC, sizeof(SAVE_MAGIC)) == 0 &&
+                 h.version == SAVE_VERSION &&
+                 h.file_size == this->size &&
+                 (h.type == SaveHeader::FULL || h.type == SaveHeader::DELTA) &&
+                 (is_delta || (h.nr_tile_entries == h.nr_tiles && h.nr_piece_entries == h.nr_pieces));
+    for(unsigned int i=0; i<5 && valid; i++) {
+        // written such that a huge offset cannot wrap around
+        valid = (sections[i][0] % 4 == 0) && (sections[i][0] <= this->size) && (sections[i][1] <= this->size - sections[i][0]);
+    }
+
+    if(!valid) {
+        std::cerr << "[ERROR] " << filename << " is not a valid save file (version " << SAVE_VERSION << ")" << std::endl;
+        this->close();
+        return false;
+    }
+
+    this->tile_ids = (const uint32_t*)(base + h.offset_tile_ids);
+    this->fields = (const float*)(base + h.offset_fields);
+    this->owners = (const uint32_t*)(base + h.offset_owners);
+    this->piece_ids = (const uint32_t*)(base + h.offset_piece_ids);
+    this->pieces = (const SavePiece*)(base + h.offset_pieces);
+
+    return true;
+}
+
+/**
+ * @brief       unmap the file
+ */
+void SaveFile::close() {
+    if(this->data != MAP_FAILED) {
+        munmap(this->data, this->size);
+        this->data = MAP_FAILED;
+    }
+
+    if(this->fd >= 0) {
+        ::close(this->fd);
+        this->fd = -1;
+    }
+
+    this->header = NULL;
+}
+
+/**
+ * @brief       write the contents of this file into a snapshot
+ *
+ * @param       snapshot        snapshot to write to
+ *
+ * @return      whether the save could be applied
+ */
+bool SaveFile::apply(SaveSnapshot* snapshot) const {
+    const SaveHeader& h = *this->header;
+    const uint32_t entries = h.nr_tile_entries;
+
+    if(h.type == SaveHeader::FULL) {
+        snapshot->tick = h.tick;
+        snapshot->nr_tiles = h.nr_tiles;
+        snapshot->nr_fields = h.nr_fields;
+        snapshot->fields.assign(this->fields, this->fields + (size_t)h.nr_fields * h.nr_tiles);
+        snapshot->owners.assign(this->owners, this->owners + h.nr_tiles);
+        snapshot->pieces.assign(this->pieces, this->pieces + h.nr_pieces);
+        return this->check_pieces(*snapshot);
+    }
+
+    if(snapshot->tick != h.base_tick || snapshot->nr_tiles != h.nr_tiles || snapshot->nr_fields != h.nr_fields) {
+        std::cerr << "[ERROR] Delta save does not belong to the loaded save (tick " << h.base_tick << ")" << std::endl;
+        return false;
+    }
+
+    for(uint32_t i=0; i<entries; i++) {
+        if(this->tile_ids[i] >= h.nr_tiles) {
+            std::cerr << "[ERROR] Delta save refers to an invalid tile" << std::endl;
+            return false;
+        }
+    }
+    for(uint32_t i=0; i<h.nr_piece_entries; i++) {
+        if(this->piece_ids[i] >= h.nr_pieces) {
+            std::cerr << "[ERROR] Delta save refers to an invalid piece" << std::endl;
+            return false;
+        }
+    }
+
+    // pieces beyond the loaded ones must all be stored in the delta; check
+    // this before anything is modified, such that the size of a corrupt
+    // header is never used to grow the snapshot
+    const size_t nr_old_pieces = snapshot->pieces.size();
+    if(h.nr_pieces > nr_old_pieces) {
+        if(h.nr_pieces - nr_old_pieces > h.nr_piece_entries) {
+            std::cerr << "[ERROR] Delta save lacks the data of added pieces" << std::endl;
+            return false;
+        }
+
+        std::vector<bool> covered(h.nr_pieces - nr_old_pieces, false);
+        for(uint32_t i=0; i<h.nr_piece_entries; i++) {
+            if(this->piece_ids[i] >= nr_old_pieces) {
+                covered[this->piece_ids[i] - nr_old_pieces] = true;
+            }
+        }
+        if(std::find(covered.begin(), covered.end(), false) != covered.end()) {
+            std::cerr << "[ERROR] Delta save lacks the data of added pieces" << std::endl;
+            return false;
+        }
+    }
+
+    for(uint32_t f=0; f<h.nr_fields; f++) {
+        float* dest = &snapshot->fields[(size_t)f * h.nr_tiles];
+        const float* src = this->fields + (size_t)f * entries;
+        for(uint32_t i=0; i<entries; i++) {
+            dest[this->tile_ids[i]] = src[i];
+        }
+    }
+    for(uint32_t i=0; i<entries; i++) {
+        snapshot->owners[this->tile_ids[i]] = this->owners[i];
+    }
+
+    snapshot->pieces.resize(h.nr_pieces);
+    for(uint32_t i=0; i<h.nr_piece_entries; i++) {
+        snapshot->pieces[this->piece_ids[i]] = this->pieces[i];
+    }
+
+    snapshot->tick = h.tick;
+
+    return this->check_pieces(*snapshot);
+}
+
+/**
+ * @brief       check that all pieces of a snapshot stand on a tile of the world
+ *
+ * @param       snapshot        snapshot to check
+ *
+ * @return      whether the pieces are valid
+ */
+bool SaveFile::check_pieces(const SaveSnapshot& snapshot) const {
+    for(const SavePiece& piece: snapshot.pieces) {
+        if(piece.tile >= snapshot.nr_tiles) {
+            std::cerr << "[ERROR] Save places a piece on an invalid tile" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+SaveFile::~SaveFile() {
+    this->close();
+}
+
+/**
+ * @brief       write a snapshot to a file
+ *
+ * @param       filename        path to the file
+ * @param       snapshot        state to write
+ * @param       base            full snapshot to write a delta against (NULL for a full save)
+ *
+ * @return      whether the file was written
+ */
+bool SaveGame::write(const std::string& filename, const SaveSnapshot& snapshot, const SaveSnapshot* base) {
+    const uint32_t nr_tiles = snapshot.nr_tiles;
+    const uint32_t nr_fields = snapshot.nr_fields;
+
+    if(base != NULL && (base->nr_tiles != nr_tiles || base->nr_fields != nr_fields)) {
+        std::cerr << "[ERROR] Cannot write a delta against a save of a different world" << std::endl;
+        return false;
+    }
+
+    // collect the tiles and pieces that differ from the base
+    std::vector<uint32_t> tile_ids;
+    std::vector<uint32_t> piece_ids;
+    if(base != NULL) {
+        std::vector<char> changed(nr_tiles, 0);
+        for(uint32_t f=0; f<nr_fields; f++) {
+            const float* values = &snapshot.fields[(size_t)f * nr_tiles];
+            const float* base_values = &base->fields[(size_t)f * nr_tiles];
+            for(uint32_t i=0; i<nr_tiles; i++) {
+                changed[i] |= std::memcmp(&values[i], &base_values[i], sizeof(float)) != 0;
+            }
+        }
+        for(uint32_t i=0; i<nr_tiles; i++) {
+            if(changed[i] || snapshot.owners[i] != base->owners[i]) {
+                tile_ids.push_back(i);
+            }
+        }
+        for(uint32_t i=0; i<snapshot.pieces.size(); i++) {
+            if(i >= base->pieces.size() || !(snapshot.pieces[i] == base->pieces[i])) {
+                piece_ids.push_back(i);
+            }
+        }
+    }
+
+    SaveHeader header;
+    std::memset(&header, 0, sizeof(SaveHeader));
+    std::memcpy(header.magic, SAVE_MAGIC, sizeof(SAVE_MAGIC));
+    header.version = SAVE_VERSION;
+    header.type = (base == NULL) ? SaveHeader::FULL : SaveHeader::DELTA;
+    header.tick = snapshot.tick;
+    header.base_tick = (base == NULL) ? snapshot.tick : base->tick;
+    header.nr_tiles = nr_tiles;
+    header.nr_fields = nr_fields;
+    header.nr_pieces = snapshot.pieces.size();
+    header.nr_tile_entries = (base == NULL) ? nr_tiles : tile_ids.size();
+    header.nr_piece_entries = (base == NULL) ? snapshot.pieces.size() : piece_ids.size();
+
+    // lay out the sections behind the header
+    const uint32_t entries = header.nr_tile_entries;
+    header.offset_tile_ids = align_offset(sizeof(SaveHeader));
+    header.offset_fields = align_offset(header.offset_tile_ids + tile_ids.size() * sizeof(uint32_t));
+    header.offset_owners = align_offset(header.offset_fields + (uint64_t)nr_fields * entries * sizeof(float));
+    header.offset_piece_ids = align_offset(header.offset_owners + entries * sizeof(uint32_t));
+    header.offset_pieces = align_offset(header.offset_piece_ids + piece_ids.size() * sizeof(uint32_t));
+    header.file_size = header.offset_pieces + header.nr_piece_entries * sizeof(SavePiece);
+
+    // write to a temporary file first, such that a crash never leaves a broken save behind
+    const std::string tmpfile = filename + ".tmp";
+    std::ofstream out(tmpfile.c_str(), std::ios::binary | std::ios::trunc);
+    if(!out.is_open()) {
+        std::cerr << "[ERROR] Cannot write save file " << tmpfile << std::endl;
+        return false;
+    }
+
+    static const char padding[8] = {0};
+    auto write_section = [&out](uint64_t offset, const void* src, size_t bytes) {
+        const uint64_t pos = out.tellp();
+        out.write(padding, offset - pos);
+        out.write((const char*)src, bytes);
+    };
+
+    out.write((const char*)&header, sizeof(SaveHeader));
+    write_section(header.offset_tile_ids, tile_ids.data(), tile_ids.size() * sizeof(uint32_t));
+
+    if(base == NULL) {
+        write_section(header.offset_fields, snapshot.fields.data(), snapshot.fields.size() * sizeof(float));
+        write_section(header.offset_owners, snapshot.owners.data(), nr_tiles * sizeof(uint32_t));
+        write_section(header.offset_piece_ids, NULL, 0);
+        write_section(header.offset_pieces, snapshot.pieces.data(), snapshot.pieces.size() * sizeof(SavePiece));
+    } else {
+        // the arrays of the fields are stored back-to-back
+        write_section(header.offset_fields, NULL, 0);
+        std::vector<float> values(entries);
+        for(uint32_t f=0; f<nr_fields; f++) {
+            const float* src = &snapshot.fields[(size_t)f * nr_tiles];
+            for(uint32_t i=0; i<entries; i++) {
+                values[i] = src[tile_ids[i]];
+            }
+            out.write((const char*)values.data(), entries * sizeof(float));
+        }
+
+        std::vector<uint32_t> owners(entries);
+        for(uint32_t i=0; i<entries; i++) {
+            owners[i] = snapshot.owners[tile_ids[i]];
+        }
+        write_section(header.offset_owners, owners.data(), entries * sizeof(uint32_t));
+        write_section(header.offset_piece_ids, piece_ids.data(), piece_ids.size() * sizeof(uint32_t));
+
+        std::vector<SavePiece> pieces(piece_ids.size());
+        for(uint32_t i=0; i<piece_ids.size(); i++) {
+            pieces[i] = snapshot.pieces[piece_ids[i]];
+        }
+        write_section(header.offset_pieces, pieces.data(), pieces.size() * sizeof(SavePiece));
+    }
+
+    out.close();
+    if(!out.good() || std::rename(tmpfile.c_str(), filename.c_str()) != 0) {
+        std::cerr << "[ERROR] Cannot write save file " << filename << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief       load a full save and optionally a delta on top of it
+ *
+ * @param       filename        path to the full save
+ * @param       delta           path to the delta save (empty for none)
+ * @param       snapshot        snapshot to load into
+ *
+ * @return      whether the save was loaded
+ */
+bool SaveGame::load(const std::string& filename, const std::string& delta, SaveSnapshot* snapshot) {
+    SaveFile file;
+    if(!file.open(filename) || !file.apply(snapshot)) {
+        return false;
+    }
+
+    if(!delta.empty()) {
+        SaveFile delta_file;
+        if(!delta_file.open(delta) || !delta_file.apply(snapshot)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief       advance the autosave timer
+ *
+ * @param       dt              elapsed time in seconds
+ *
+ * @return      pointer to the capture buffer when an autosave is due, NULL otherwise
+ */
+SaveSnapshot* SaveGame::update(double dt) {
+    this->accumulator += dt;
+
+    // never wait for the writer on the main thread; retry next frame instead
+    if(this->accumulator < this->interval || (this->writer && !this->writer->flag_finished)) {
+        return NULL;
+    }
+
+    this->accumulator = 0.0;
+    this->finish();
+
+    return &this->capture;
+}
+
+/**
+ * @brief       start writing the capture buffer in the background
+ */
+void SaveGame::commit() {
+    this->finish();
+    // a background job, such that a thread waiting for other work never ends up writing the file
+    this->writer = JobSystem::get().submit_background([this]() {
+        this->write_autosave();
+    });
+}
+
+/**
+ * @brief       wait for the autosave in progress (if any)
+ */
+void SaveGame::finish() {
+    if(this->writer) {
+        JobSystem::get().wait(this->writer);
+        this->writer.reset();
+    }
+}
+
+SaveGame::~SaveGame() {
+    this->finish();
+}
+
+SaveGame::SaveGame() :
+    accumulator(0.0),
+    nr_autosaves(0) {
+
+    // the job system has to outlive this object, which waits for its writer upon destruction
+    JobSystem::get();
+
+    this->directory = AssetManager::get().get_root_directory() + Settings::get().get_string_from_keyword("settings.autosave.directory") + "/";
+    this->interval = Settings::get().get_float_from_keyword("settings.autosave.interval");
+    this->full_every = std::max(1u, Settings::get().get_uint_from_keyword("settings.autosave.full_every"));
+
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(this->directory, ec);
+}
+
+/**
+ * @brief       write the capture buffer as full or delta save
+ */
+void SaveGame::write_autosave() {
+    const bool full = (this->nr_autosaves % this->full_every == 0) ||
+                      this->base.nr_tiles != this->capture.nr_tiles;
+
+    if(full) {
+        if(SaveGame::write(this->get_full_filename(), this->capture, NULL)) {
+            // the delta of the previous full save can no longer be applied
+            boost::system::error_code ec;
+            boost::filesystem::remove(this->get_delta_filename(), ec);
+
+            // keep the written state as the base of the deltas; the old base
+            // becomes the next capture buffer, such that no memory is reallocated
+            std::swap(this->base, this->capture);
+        }
+    } else {
+        SaveGame::write(this->get_delta_filename(), this->capture, &this->base);
+    }
+
+    this->nr_autosaves++;
+}
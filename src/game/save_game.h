@@ -0,0 +1,255 @@
+/**************************************************************************
+ *   save_game.h  --  This file is part of Acardov.                       *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _SAVE_GAME_H
+#define _SAVE_GAME_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "core/job_system.h"
+
+/**
+ * @struct SavePiece
+ * @brief  record of a single piece in a save file
+ */
+struct SavePiece {
+    uint32_t tile;      //!< tile the piece is placed on
+    uint32_t type;      //!< piece type
+    uint32_t owner;     //!< owning player
+
+    inline bool operator==(const SavePiece& other) const {
+        return this->tile == other.tile && this->type == other.type && this->owner == other.owner;
+    }
+};
+
+/**
+ * @struct SaveHeader
+ * @brief  header at the start of every save file
+ *
+ * All sections are stored contiguously after the header and are referred to
+ * by their byte offset from the start of the file. A full save holds every
+ * tile and piece; a delta save only holds the tiles and pieces that changed
+ * with respect to the full save it is based on, together with their ids.
+ */
+struct SaveHeader {
+    char magic[8];              //!< file identifier
+    uint32_t version;           //!< version of the format
+    uint32_t type;              //!< full or delta save
+    uint64_t tick;              //!< simulation tick of the save
+    uint64_t base_tick;         //!< simulation tick of the full save a delta is based on
+    uint32_t nr_tiles;          //!< number of tiles of the world
+    uint32_t nr_fields;         //!< number of simulation fields per tile
+    uint32_t nr_pieces;         //!< number of pieces of the world
+    uint32_t nr_tile_entries;   //!< number of tiles stored in this file
+    uint32_t nr_piece_entries;  //!< number of pieces stored in this file
+    uint32_t reserved;
+    uint64_t offset_tile_ids;   //!< ids of the stored tiles (delta only)
+    uint64_t offset_fields;     //!< field values, one array per field
+    uint64_t offset_owners;     //!< owner per stored tile
+    uint64_t offset_piece_ids;  //!< ids of the stored pieces (delta only)
+    uint64_t offset_pieces;     //!< piece records
+    uint64_t file_size;         //!< total size of the file in bytes
+
+    enum {
+        FULL,
+        DELTA
+    };
+};
+
+/**
+ * @struct SaveSnapshot
+ * @brief  copy of the persistent state of the game
+ */
+struct SaveSnapshot {
+    uint64_t tick;                      //!< simulation tick
+    uint32_t nr_tiles;                  //!< number of tiles
+    uint32_t nr_fields;                 //!< number of fields per tile
+    std::vector<float> fields;          //!< field values, one array of nr_tiles per field
+    std::vector<uint32_t> owners;       //!< owner per tile
+    std::vector<SavePiece> pieces;      //!< piece table
+
+    SaveSnapshot() : tick(0), nr_tiles(0), nr_fields(0) {}
+};
+
+/**
+ * @class SaveFile
+ * @brief Save file that is mapped into memory
+ *
+ * Opening a save file maps it and sets the section pointers to the offsets
+ * given in the header; no data is copied or parsed.
+ */
+class SaveFile {
+private:
+    int fd;                             //!< file descriptor
+    void* data;                         //!< start of the mapping
+    size_t size;                        //!< size of the mapping
+
+    const SaveHeader* header;           //!< file header
+    const uint32_t* tile_ids;           //!< ids of the stored tiles (delta only)
+    const float* fields;                //!< field values
+    const uint32_t* owners;             //!< owners of the stored tiles
+    const uint32_t* piece_ids;          //!< ids of the stored pieces (delta only)
+    const SavePiece* pieces;            //!< piece records
+
+public:
+    SaveFile();
+
+    /**
+     * @brief       map a save file and validate its header
+     *
+     * @param       filename        path to the file
+     *
+     * @return      whether the file is a valid save file
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief       unmap the file
+     */
+    void close();
+
+    /**
+     * @brief       write the contents of this file into a snapshot
+     *
+     * A full save replaces the snapshot; a delta save is applied on top of
+     * the snapshot of the full save it is based on.
+     *
+     * @param       snapshot        snapshot to write to
+     *
+     * @return      whether the save could be applied
+     */
+    bool apply(SaveSnapshot* snapshot) const;
+
+    inline const SaveHeader& get_header() const {
+        return *this->header;
+    }
+
+    ~SaveFile();
+
+private:
+    /**
+     * @brief       check that all pieces of a snapshot stand on a tile of the world
+     */
+    bool check_pieces(const SaveSnapshot& snapshot) const;
+
+    SaveFile(SaveFile const&)           = delete;
+    void operator=(SaveFile const&)     = delete;
+};
+
+/**
+ * @class SaveGame
+ * @brief Writes save files and performs the periodic autosave
+ *
+ * Autosaves are written by a background job of the job system, which only the
+ * workers execute. The main thread only copies the state into a capture
+ * buffer; when the previous autosave is still being written, the autosave is
+ * postponed rather than waited for. Every few
+ * autosaves a full save is written; the ones in between only hold the tiles
+ * and pieces that differ from that full save.
+ */
+class SaveGame {
+private:
+    std::string directory;              //!< directory of the autosaves
+    double interval;                    //!< time in between autosaves in seconds
+    double accumulator;                 //!< time since the last autosave
+    unsigned int full_every;            //!< number of autosaves per full save
+    unsigned int nr_autosaves;          //!< number of autosaves written
+
+    SaveSnapshot base;                  //!< state of the last full autosave (owned by the writer)
+    SaveSnapshot capture;               //!< state to be written
+    JobHandle writer;                   //!< job writing the autosave (NULL when none was started)
+
+public:
+    /**
+     * @brief       get a reference to the save game object
+     *
+     * @return      reference to the save game object (singleton pattern)
+     */
+    static SaveGame& get() {
+        static SaveGame save_game_instance;
+        return save_game_instance;
+    }
+
+    /**
+     * @brief       write a snapshot to a file
+     *
+     * @param       filename        path to the file
+     * @param       snapshot        state to write
+     * @param       base            full snapshot to write a delta against (NULL for a full save)
+     *
+     * @return      whether the file was written
+     */
+    static bool write(const std::string& filename, const SaveSnapshot& snapshot, const SaveSnapshot* base);
+
+    /**
+     * @brief       load a full save and optionally a delta on top of it
+     *
+     * @param       filename        path to the full save
+     * @param       delta           path to the delta save (empty for none)
+     * @param       snapshot        snapshot to load into
+     *
+     * @return      whether the save was loaded
+     */
+    static bool load(const std::string& filename, const std::string& delta, SaveSnapshot* snapshot);
+
+    /**
+     * @brief       advance the autosave timer
+     *
+     * @param       dt              elapsed time in seconds
+     *
+     * @return      pointer to the capture buffer when an autosave is due, NULL otherwise
+     */
+    SaveSnapshot* update(double dt);
+
+    /**
+     * @brief       start writing the capture buffer in the background
+     */
+    void commit();
+
+    /**
+     * @brief       wait for the autosave in progress (if any)
+     */
+    void finish();
+
+    inline std::string get_full_filename() const {
+        return this->directory + "autosave.sav";
+    }
+
+    inline std::string get_delta_filename() const {
+        return this->directory + "autosave_delta.sav";
+    }
+
+    ~SaveGame();
+
+private:
+    SaveGame();
+
+    /**
+     * @brief       write the capture buffer as full or delta save
+     */
+    void write_autosave();
+
+    SaveGame(SaveGame const&)           = delete;
+    void operator=(SaveGame const&)     = delete;
+};
+
+#endif //_SAVE_GAME_H
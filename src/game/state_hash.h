@@ -0,0 +1,103 @@
+/**************************************************************************
+ *   state_hash.h  --  This file is part of Acardov.                      *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _STATE_HASH_H
+#define _STATE_HASH_H
+
+#include <cstdint>
+#include <cstring>
+
+#include "game/entities/components.h"
+
+/**
+ * @class StateHash
+ * @brief Zobrist keys of the features of the game state
+ *
+ * The hash of the game is the exclusive or of the keys of all features that
+ * are present (a tile being owned by a player, a piece standing on a tile,
+ * the stats of a piece). A change of a single feature therefore updates the
+ * hash in constant time by xor-ing the old key out and the new key in.
+ *
+ * Instead of looking the keys up in tables of random numbers, they are
+ * obtained by scrambling the feature with the splitmix64 finalizer. This
+ * gives keys of the same quality without tables whose size would depend on
+ * the number of players or pieces.
+ */
+class StateHash {
+private:
+    // distinguish the feature types, such that equal arguments give different keys
+    static const uint64_t SALT_OWNER = 0x6A09E667F3BCC908ULL;
+    static const uint64_t SALT_PIECE = 0xBB67AE8584CAA73BULL;
+    static const uint64_t SALT_STATS = 0x3C6EF372FE94F82BULL;
+
+public:
+    /**
+     * @brief       scramble a 64-bit value (splitmix64 finalizer)
+     */
+    static inline uint64_t mix(uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    /**
+     * @brief       key of a tile being owned by a player (unowned tiles do not contribute)
+     *
+     * @param       tile            tile id
+     * @param       owner           owner of the tile
+     */
+    static inline uint64_t tile_owner(unsigned int tile, unsigned int owner) {
+        if(owner == 0) {
+            return 0;
+        }
+        return mix((((uint64_t)tile << 32) | owner) ^ SALT_OWNER);
+    }
+
+    /**
+     * @brief       key of a piece standing on a tile
+     *
+     * @param       entity          entity index of the piece
+     * @param       generation      generation of the entity slot
+     * @param       tile            tile id
+     */
+    static inline uint64_t piece_tile(uint32_t entity, uint32_t generation, unsigned int tile) {
+        return mix(mix((((uint64_t)entity << 32) | generation) ^ SALT_PIECE) ^ tile);
+    }
+
+    /**
+     * @brief       key of the stats of a piece
+     *
+     * @param       entity          entity index of the piece
+     * @param       generation      generation of the entity slot
+     * @param       stats           stats of the piece
+     */
+    static inline uint64_t piece_stats(uint32_t entity, uint32_t generation, const PieceStats& stats) {
+        uint32_t health, strength;
+        std::memcpy(&health, &stats.health, sizeof(float));
+        std::memcpy(&strength, &stats.strength, sizeof(float));
+
+        uint64_t key = mix((((uint64_t)entity << 32) | generation) ^ SALT_STATS);
+        key = mix(key ^ (((uint64_t)stats.type << 32) | stats.owner));
+        key = mix(key ^ (((uint64_t)health << 32) | strength));
+        return key;
+    }
+};
+
+#endif //_STATE_HASH_H
@@ -29,8 +29,16 @@
  */
 Geometry::Geometry(unsigned int nr_subdivisions) {
     this->generate_icosahedron();
+
+    // the vertices of the base shape are their own parent
+    for(unsigned int i=0; i<this->vertices.size(); i++) {
+        this->parents.push_back(i);
+    }
+    this->level_sizes.push_back(this->vertices.size());
+
     for(unsigned int i=0; i<nr_subdivisions; i++) {
         this->subdivide();
+        this->level_sizes.push_back(this->vertices.size());
     }
 }
 
@@ -66,30 +74,8 @@ void Geometry::load_vertices_gpu(GLuint* vao, GLuint* vbo, unsigned int *nr) {
     }
     *nr = indices.size();
 
-    // load vao and vbo
-    glGenVertexArrays(1, vao);
-    glBindVertexArray(*vao);
-    glGenBuffers(4, vbo);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[0]);
-    glBufferData(GL_ARRAY_BUFFER, verts.size() * 3 * sizeof(float), &verts[0][0], GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[1]);
-    glBufferData(GL_ARRAY_BUFFER, verts.size() * 3 * sizeof(float), &cols[0][0], GL_STATIC_DRAW);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[2]);
-    glBufferData(GL_ARRAY_BUFFER, cols.size() * 3 * sizeof(float), &cols[0][0], GL_STATIC_DRAW);
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo[3]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-
-    glBindVertexArray(0);
+    // the colors double as normals
+    this->load_colored_vertices_gpu(vao, vbo, verts, cols, cols, indices);
 }
 
 /*
@@ -142,30 +128,8 @@ void Geometry::load_vertices_dual_gpu(GLuint* vao, GLuint* vbo, unsigned int *nr
     }
     *nr = indices.size();
 
-    // load vao and vbo
-    glGenVertexArrays(1, vao);
-    glBindVertexArray(*vao);
-    glGenBuffers(4, vbo);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[0]);
-    glBufferData(GL_ARRAY_BUFFER, verts.size() * 3 * sizeof(float), &verts[0][0], GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[1]);
-    glBufferData(GL_ARRAY_BUFFER, verts.size() * 3 * sizeof(float), &verts[0][0], GL_STATIC_DRAW);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[2]);
-    glBufferData(GL_ARRAY_BUFFER, colors.size() * 3 * sizeof(float), &colors[0][0], GL_STATIC_DRAW);
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo[3]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-
-    glBindVertexArray(0);
+    // the vertices lie on the unit sphere, hence double as normals
+    this->load_colored_vertices_gpu(vao, vbo, verts, verts, colors, indices);
 }
 
 /*
@@ -202,20 +166,56 @@ void Geometry::load_lines_dual_gpu(GLuint* vao, GLuint* vbo, unsigned int *nr) {
     }
     *nr = indices.size();
 
+    std::vector<VertexP> vertices(verts.size());
+    for(unsigned int i=0; i<verts.size(); i++) {
+        vertices[i].position = verts[i];
+    }
+
     // load vao and vbo
+    LayoutP::load_indexed(vao, vbo, vertices, indices);
+}
+
+/*
+ * @brief   Load colored triangles on the gpu
+ *
+ * The positions and packed normals are interleaved in the first buffer
+ * (LayoutPN); the packed colors live in a separate buffer (LayoutC), such
+ * that they can be rewritten without touching the vertices.
+ *
+ * @param   Pointer to vertex attribute object
+ * @param   Pointer to vertex buffer object array (vertices, colors, indices)
+ * @param   Vertex positions
+ * @param   Vertex normals
+ * @param   Vertex colors
+ * @param   Indices
+ *
+ * @return  void
+ */
+void Geometry::load_colored_vertices_gpu(GLuint* vao, GLuint* vbo,
+                                         const std::vector<glm::vec3>& positions,
+                                         const std::vector<glm::vec3>& normals,
+                                         const std::vector<glm::vec3>& colors,
+                                         const std::vector<unsigned int>& indices) {
+    std::vector<VertexPN> vertices(positions.size());
+    std::vector<VertexC> packed_colors(positions.size());
+    for(unsigned int i=0; i<positions.size(); i++) {
+        vertices[i].position = positions[i];
+        vertices[i].normal = pack_normal(glm::normalize(normals[i]));
+        packed_colors[i].color = pack_color(colors[i]);
+    }
+
     glGenVertexArrays(1, vao);
-    glBindVertexArray(*vao);
-    glGenBuffers(2, vbo);
+    GLState::get().bind_vertex_array(*vao);
+    glGenBuffers(3, vbo);
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[0]);
-    glBufferData(GL_ARRAY_BUFFER, verts.size() * 3 * sizeof(float), &verts[0][0], GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+    LayoutPN::load(vbo[0], vertices);
+    LayoutC::load(vbo[1], packed_colors);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo[1]);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo[2]);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
 
-    glBindVertexArray(0);
+    GLState::get().bind_vertex_array(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void Geometry::load_tiles(std::vector<std::unique_ptr<Tile> > *tiles) {
@@ -229,11 +229,12 @@ void Geometry::load_tiles(std::vector<std::unique_ptr<Tile> > *tiles) {
         HalfEdge* edge = vertex->get_edge();
         Tile* tile = tiles->at(i).get();
 
-        // set all neighbours
+        // set all neighbours; the edges around a vertex all emanate from
+        // that vertex, hence the neighbour is found at the opposite end
         unsigned int count = 0;
         do {
             count++;
-            unsigned int id = edge->get_vertex()->get_id();
+            unsigned int id = edge->get_pair()->get_vertex()->get_id();
             tile->add_neighbour(tiles->at(id).get());
 
             edge = edge->get_pair()->get_next();
@@ -248,6 +249,11 @@ void Geometry::load_tiles(std::vector<std::unique_ptr<Tile> > *tiles) {
     }
 }
 
+void Geometry::load_hierarchy(std::vector<unsigned int> *_parents, std::vector<unsigned int> *_level_sizes) const {
+    *_parents = this->parents;
+    *_level_sizes = this->level_sizes;
+}
+
 void Geometry::generate_square() {
     /****************#
     #                #
@@ -768,6 +774,7 @@ void Geometry::split_edge(HalfEdge* edge) {
 
     // finally place all new vertices, halfedges and faces in the vectors
     this->add_vertex(m);
+    this->parents.push_back(b->get_id());
 
     // remember; bm and mb are made using bc and cb
     if(has_A) {
@@ -35,6 +35,8 @@
 #define GLM_FORCE_RADIANS
 #include <glm/gtx/string_cast.hpp>
 
+#include "core/gl_state.h"
+#include "core/vertex_layout.h"
 #include "game/terrain/tile.h"
 #include "util/mathfunc.h"
 
@@ -209,6 +211,9 @@ private:
     std::vector<std::unique_ptr<Face> > faces;          //!< vector holding all faces
     std::vector<std::unique_ptr<HalfEdge> > edges;      //!< vector holding all half edges
 
+    std::vector<unsigned int> parents;                  //!< vertex of the previous level a vertex was split from
+    std::vector<unsigned int> level_sizes;              //!< number of vertices after each subdivision
+
 public:
     /*
      * @brief   Geometry constructor class
@@ -254,6 +259,20 @@ public:
 
     void load_tiles(std::vector<std::unique_ptr<Tile> > *tiles);
 
+    /*
+     * @brief   Load the subdivision hierarchy of the vertices
+     *
+     * Vertices keep their id upon subdivision, hence a vertex at level l
+     * also exists at all finer levels. A vertex created by splitting an
+     * edge has one of the end points of that edge as parent.
+     *
+     * @param   Pointer to vector receiving the parent of each vertex
+     * @param   Pointer to vector receiving the number of vertices per level
+     *
+     * @return  void
+     */
+    void load_hierarchy(std::vector<unsigned int> *_parents, std::vector<unsigned int> *_level_sizes) const;
+
     // deconstructor
     ~Geometry() {}
 
@@ -271,6 +290,24 @@ private:
     void split_edge(HalfEdge* edge);
 
     void add_vertex(Vertex* vertex);
+
+    /*
+     * @brief   Load colored triangles on the gpu
+     *
+     * @param   Pointer to vertex attribute object
+     * @param   Pointer to vertex buffer object array (vertices, colors, indices)
+     * @param   Vertex positions
+     * @param   Vertex normals
+     * @param   Vertex colors
+     * @param   Indices
+     *
+     * @return  void
+     */
+    void load_colored_vertices_gpu(GLuint* vao, GLuint* vbo,
+                                   const std::vector<glm::vec3>& positions,
+                                   const std::vector<glm::vec3>& normals,
+                                   const std::vector<glm::vec3>& colors,
+                                   const std::vector<unsigned int>& indices);
 };
 
 #endif //_VERTEX_H
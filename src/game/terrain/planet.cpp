@@ -21,10 +21,22 @@
 #include "planet.h"
 
 Planet::Planet() {
+    this->flag_headless = Headless::get().is_enabled();
+    this->hash = 0;
+
     this->geometry = std::unique_ptr<Geometry>(new Geometry(4));
+    this->geometry->load_tiles(&this->tiles);
+    this->range = std::unique_ptr<TileRange>(new TileRange(this->tiles));
+    this->territories = std::unique_ptr<TileComponents>(new TileComponents(this->range.get()));
+    this->load_simulation();
+
+    if(this->flag_headless) {
+        return;
+    }
+
     this->geometry->load_vertices_dual_gpu(&this->vao_tiles, &this->vbo_tiles[0], &this->nr_vertices);
     this->geometry->load_lines_dual_gpu(&this->vao_lines, &this->vbo_lines[0], &this->nr_lines);
-    this->geometry->load_tiles(&this->tiles);
+    this->load_borders();
     this->load_assets();
     this->load_shaders();
 
@@ -32,64 +44,207 @@ Planet::Planet() {
 }
 
 void Planet::draw() {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-
-    // draw all tiles
-    this->shader_tiles->link_shader();
-
-    const glm::mat4 mvp_tiles = Camera::get().get_projection() * Camera::get().get_view();
-    this->shader_tiles->set_uniform("mvp", &mvp_tiles[0][0]);
-
-    glBindVertexArray(this->vao_tiles);
-    glDrawElements(GL_TRIANGLES, this->nr_vertices, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
-
-    this->shader_tiles->unlink_shader();
-
-    // draw all lines
-    this->shader_lines->link_shader();
-
-    static const float s = 1.001f;
-    const glm::mat4 mvp_lines = mvp_tiles * glm::scale(glm::vec3(s,s,s));
-    this->shader_lines->set_uniform("mvp", &mvp_lines[0][0]);
-
-    glBindVertexArray(this->vao_lines);
-    glDrawElements(GL_LINES, this->nr_lines, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
-
-    this->shader_lines->unlink_shader();
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glActiveTexture(GL_TEXTURE0);
+    // the camera is taken from the per-frame uniform block; the remaining
+    // uniforms never change and are set when the shaders are loaded
+    DrawItem item = DrawItem();
+    item.mode = GL_TRIANGLES;
+    item.texture_unit = 0;
+    item.texture = this->texture_id;
+
+    // tiles
+    item.program = this->shader_tiles->get_program();
+    item.vao = this->vao_tiles;
+    item.count = this->nr_vertices;
+    RenderQueue::get().submit(RenderQueue::PASS_OPAQUE, 0, item);
+
+    // lines and territory borders are blended on top of the tiles, in this order
+    item.mode = GL_LINES;
+    item.count = this->nr_lines;
+
+    item.program = this->shader_lines->get_program();
+    item.vao = this->vao_lines;
+    RenderQueue::get().submit(RenderQueue::PASS_TRANSPARENT, 0, item);
+
+    item.program = this->shader_borders->get_program();
+    item.vao = this->vao_borders;
+    RenderQueue::get().submit(RenderQueue::PASS_TRANSPARENT, 1, item);
 }
 
 void Planet::update(double dt) {
+    const unsigned long int nr_ticks = this->simulation->get_nr_ticks();
+    this->simulation->update(dt);
 
+    if(this->simulation->get_nr_ticks() != nr_ticks) {
+        this->update_summary();
+    }
 }
 
 void Planet::load_shaders() {
+    // lift the lines slightly above the tiles
+    static const float s = 1.001f;
+    const glm::mat4 model_lines = glm::scale(glm::vec3(s,s,s));
+    static const glm::vec4 border_color(0.8f, 0.1f, 0.1f, 0.8f);
+
     // load shader for the tiles
     this->shader_tiles = std::unique_ptr<Shader>(new Shader("assets/shaders/planet"));
 
     this->shader_tiles->add_attribute(ShaderAttribute::POSITION, "position");
     this->shader_tiles->add_attribute(ShaderAttribute::NORMAL, "normal");
     this->shader_tiles->add_attribute(ShaderAttribute::COLOR, "color");
-    this->shader_tiles->add_uniform(ShaderUniform::MAT4, "mvp", 1);
 
-    glBindVertexArray(this->vao_tiles);
+    GLState::get().bind_vertex_array(this->vao_tiles);
     this->shader_tiles->bind_uniforms_and_attributes();
-    glBindVertexArray(0);
+    GLState::get().bind_vertex_array(0);
 
     // load shader for the lines
     this->shader_lines = std::unique_ptr<Shader>(new Shader("assets/shaders/lines"));
 
     this->shader_lines->add_attribute(ShaderAttribute::POSITION, "position");
-    this->shader_lines->add_uniform(ShaderUniform::MAT4, "mvp", 1);
+    const UniformHandle<ShaderUniform::MAT4> lines_model = this->shader_lines->add_uniform<ShaderUniform::MAT4>("model", 1);
 
-    glBindVertexArray(this->vao_lines);
+    GLState::get().bind_vertex_array(this->vao_lines);
     this->shader_lines->bind_uniforms_and_attributes();
-    glBindVertexArray(0);
+    this->shader_lines->set_uniform(lines_model, &model_lines[0][0]);
+    GLState::get().bind_vertex_array(0);
+
+    // load shader for the territory borders
+    this->shader_borders = std::unique_ptr<Shader>(new Shader("assets/shaders/borders"));
+
+    this->shader_borders->add_attribute(ShaderAttribute::POSITION, "position");
+    const UniformHandle<ShaderUniform::MAT4> borders_model = this->shader_borders->add_uniform<ShaderUniform::MAT4>("model", 1);
+    const UniformHandle<ShaderUniform::VEC4> borders_color = this->shader_borders->add_uniform<ShaderUniform::VEC4>("color", 1);
+
+    GLState::get().bind_vertex_array(this->vao_borders);
+    this->shader_borders->bind_uniforms_and_attributes();
+    this->shader_borders->set_uniform(borders_model, &model_lines[0][0]);
+    this->shader_borders->set_uniform(borders_color, &border_color[0]);
+    GLState::get().bind_vertex_array(0);
+}
+
+void Planet::load_simulation() {
+    static const double tick_rate = 10.0;   // simulation ticks per second
+
+    this->simulation = std::unique_ptr<TileSimulation>(new TileSimulation(this->range.get(), tick_rate));
+    this->simulation->add_rule(new ResourceGrowthRule(0.05f, 1.0f));
+    this->simulation->add_rule(new FireSpreadRule(0.5f, 0.1f, 0.2f));
+
+    // threat, culture, supply and temperature
+    DiffusionRule::Coefficients diffusion, decay;
+    diffusion << 2.0f, 0.5f, 1.0f, 0.2f;
+    decay << 0.5f, 0.05f, 0.3f, 0.0f;
+    this->simulation->add_rule(new DiffusionRule(*this->range, diffusion, decay));
+
+    this->simulation->fill(TileState::RESOURCES, 0.1f);
+    this->simulation->fill(TileState::FUEL, 1.0f);
+
+    // summarize all fields over the subdivision hierarchy
+    std::vector<unsigned int> parents, level_sizes;
+    this->geometry->load_hierarchy(&parents, &level_sizes);
+    this->summary = std::unique_ptr<TileSummary>(new TileSummary(parents, level_sizes, TileState::NR_FIELDS));
+    this->update_summary();
+}
+
+void Planet::set_tile_owner(unsigned int tile, unsigned int owner) {
+    if(this->territories->get_key(tile) == owner) {
+        return;
+    }
+
+    this->hash ^= StateHash::tile_owner(tile, this->territories->get_key(tile)) ^ StateHash::tile_owner(tile, owner);
+    this->territories->set_key(tile, owner);
+
+    // only the border segments of this tile and its neighbours change
+    this->update_borders(tile);
+    for(unsigned int neighbour: this->range->get_neighbours(tile)) {
+        this->update_borders(neighbour);
+    }
+}
+
+void Planet::restore(const float* fields, const unsigned int* owners, unsigned long int tick) {
+    this->simulation->restore(fields, tick);
+    this->update_summary();
+
+    this->territories->build(owners);
+    this->hash = 0;
+    for(unsigned int i=0; i<this->tiles.size(); i++) {
+        this->hash ^= StateHash::tile_owner(i, owners[i]);
+        this->update_borders(i);
+    }
+}
+
+/**
+ * @brief       publish the simulation step in flight (if any) and the queued edits
+ */
+void Planet::synchronize() {
+    this->simulation->synchronize();
+    this->update_summary();
+}
+
+/**
+ * @brief       create the index buffer of the territory borders
+ *
+ * The borders reuse the vertices of the tile lines. Every tile has a fixed
+ * slot of two indices per edge, wherein segment k is the edge shared with
+ * neighbour k. Segments that are not on a border are degenerate, such that
+ * a change of ownership only rewrites the slots of the tiles involved.
+ */
+void Planet::load_borders() {
+    std::vector<unsigned int> indices(this->nr_lines);
+    for(auto&& tile: this->tiles) {
+        const unsigned int base = tile->get_memory_offset();
+        for(unsigned int k=0; k<tile->get_size() * 2; k++) {
+            indices[base * 2 + k] = base;
+        }
+    }
+
+    glGenVertexArrays(1, &this->vao_borders);
+    GLState::get().bind_vertex_array(this->vao_borders);
+    glGenBuffers(1, &this->vbo_borders);
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->vbo_lines[0]);
+    LayoutP::set_attributes();
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->vbo_borders);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_DYNAMIC_DRAW);
+
+    GLState::get().bind_vertex_array(0);
+}
+
+/**
+ * @brief       rewrite the border segments of a single tile
+ *
+ * @param       tile        tile id
+ */
+void Planet::update_borders(unsigned int tile) {
+    if(this->flag_headless) {
+        return;
+    }
+
+    const Tile* t = this->tiles[tile].get();
+    const unsigned int base = t->get_memory_offset();
+    const unsigned int owner = this->territories->get_key(tile);
+    const TileSet neighbours = this->range->get_neighbours(tile);
+
+    unsigned int indices[12];   // a tile has at most six edges
+    for(unsigned int k=0; k<t->get_size(); k++) {
+        if(owner != 0 && this->territories->get_key(neighbours[k]) != owner) {
+            indices[k * 2] = base + k;
+            indices[k * 2 + 1] = base + (k + 1) % t->get_size();
+        } else {
+            indices[k * 2] = base;
+            indices[k * 2 + 1] = base;
+        }
+    }
+
+    GLState::get().bind_vertex_array(this->vao_borders);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, base * 2 * sizeof(unsigned int), t->get_size() * 2 * sizeof(unsigned int), indices);
+    GLState::get().bind_vertex_array(0);
+}
+
+void Planet::update_summary() {
+    const TileState& state = this->simulation->get_state();
+    for(unsigned int field=0; field<TileState::NR_FIELDS; field++) {
+        this->summary->rebuild(field, state.get_field(field));
+    }
 }
 
 void Planet::load_assets() {
@@ -97,10 +252,10 @@ void Planet::load_assets() {
 }
 
 void Planet::load_texture(const std::string& filename) {
-    glActiveTexture(GL_TEXTURE0);
+    GLState::get().active_texture(GL_TEXTURE0);
 
     glGenTextures(1, &texture_id);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
+    GLState::get().bind_texture(GL_TEXTURE_2D, texture_id);
 
     std::vector<uint8_t> pixels;
     png_uint_32 width, height;
@@ -128,32 +283,39 @@ void Planet::load_texture(const std::string& filename) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::get().bind_texture(GL_TEXTURE_2D, 0);
 }
 
 void Planet::set_poles() {
-    glBindVertexArray(this->vao_tiles);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_tiles[2]);
+    // the colors are a separate stream of the tile vertex array
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_tiles[1]);
 
-    std::vector<glm::vec3> data;
+    VertexC data[18];   // three vertices per edge, a tile has at most six edges
     for(unsigned int i=0; i<18; i++) {
-        data.push_back(hex2col("d2dadc"));
+        data[i].color = pack_color(hex2col("d2dadc"));
     }
 
     for(auto&& tile: tiles) {
         if(std::abs(tile->get_pos()[2]) > 0.9f) {
-            glBufferSubData(GL_ARRAY_BUFFER, tile->get_memory_offset() * 9 * sizeof(float), tile->get_size() * 9 * sizeof(float), &data[0][0]);
+            glBufferSubData(GL_ARRAY_BUFFER, tile->get_memory_offset() * 3 * sizeof(VertexC), tile->get_size() * 3 * sizeof(VertexC), data);
         }
     }
 
-    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 Planet::~Planet() {
-    glBindVertexArray(0);
-    glDeleteBuffers(4, this->vbo_tiles);
+    if(this->flag_headless) {
+        return;
+    }
+
+    GLState::get().bind_vertex_array(0);
+    glDeleteBuffers(3, this->vbo_tiles);
     glDeleteVertexArrays(1, &this->vao_tiles);
 
-    glDeleteBuffers(4, this->vbo_lines);
+    glDeleteBuffers(2, this->vbo_lines);
     glDeleteVertexArrays(1, &this->vao_lines);
+
+    glDeleteBuffers(1, &this->vbo_borders);
+    glDeleteVertexArrays(1, &this->vao_borders);
 }
@@ -29,30 +29,48 @@
 #include <glm/glm.hpp>
 
 #include "core/shader.h"
+#include "core/render_queue.h"
 #include "core/camera.h"
 #include "game/terrain/geometry.h"
 #include "game/terrain/tile.h"
+#include "game/terrain/tile_range.h"
+#include "game/terrain/tile_simulation.h"
+#include "game/terrain/tile_diffusion.h"
+#include "game/terrain/tile_summary.h"
+#include "game/terrain/tile_components.h"
 #include "util/pngfuncs.h"
+#include "core/headless.h"
+#include "game/state_hash.h"
 
 class Planet {
 private:
     std::unique_ptr<Shader> shader_tiles;
     std::unique_ptr<Shader> shader_lines;
+    std::unique_ptr<Shader> shader_borders;
 
     std::vector<std::unique_ptr<Tile> > tiles;
+    std::unique_ptr<TileRange> range;
+    std::unique_ptr<TileSimulation> simulation;
+    std::unique_ptr<TileSummary> summary;
+    std::unique_ptr<TileComponents> territories;
 
+    bool flag_headless;     //!< whether the planet lives without GPU resources
+    uint64_t hash;          //!< Zobrist hash of the tile owners
     float angle;
     std::unique_ptr<Geometry> geometry;
     GLuint texture_id;
 
     GLuint vao_tiles;
-    GLuint vbo_tiles[4];
+    GLuint vbo_tiles[3];
     unsigned int nr_vertices;
 
     GLuint vao_lines;
     GLuint vbo_lines[2];
     unsigned int nr_lines;
 
+    GLuint vao_borders;
+    GLuint vbo_borders;
+
 public:
     /**
      * @brief       get a reference to the camera object
@@ -72,6 +90,78 @@ public:
         return this->tiles[id].get();
     }
 
+    inline unsigned int get_nr_tiles() const {
+        return this->tiles.size();
+    }
+
+    /**
+     * @brief       get the range query object of the planet (main thread only)
+     *
+     * @return      reference to the tile range object
+     */
+    inline TileRange& get_range() {
+        return *this->range;
+    }
+
+    /**
+     * @brief       get the cellular simulation running on the tiles
+     *
+     * @return      reference to the tile simulation object
+     */
+    inline TileSimulation& get_simulation() {
+        return *this->simulation;
+    }
+
+    /**
+     * @brief       get the regional aggregates of the simulation fields
+     *
+     * @return      reference to the tile summary object
+     */
+    inline const TileSummary& get_summary() const {
+        return *this->summary;
+    }
+
+    /**
+     * @brief       get the contiguous territories of the tile owners
+     *
+     * @return      reference to the labelling of the territories
+     */
+    inline const TileComponents& get_territories() const {
+        return *this->territories;
+    }
+
+    /**
+     * @brief       change the owner of a tile
+     *
+     * @param       tile        tile id
+     * @param       owner       owner id (zero when not owned)
+     */
+    void set_tile_owner(unsigned int tile, unsigned int owner);
+
+    /**
+     * @brief       replace the state of all tiles, e.g. when loading a saved game
+     *
+     * @param       fields      values of all simulation fields (one array per field)
+     * @param       owners      owner of every tile
+     * @param       tick        simulation tick of the state
+     */
+    void restore(const float* fields, const unsigned int* owners, unsigned long int tick);
+
+    /**
+     * @brief       publish the simulation step in flight (if any) and the queued edits
+     *
+     * Afterwards the visible state is the latest one and no step is running;
+     * finishing a step early does not change the outcome of the simulation.
+     */
+    void synchronize();
+
+    /**
+     * @brief       get the hash of the owners of all tiles
+     */
+    inline uint64_t get_hash() const {
+        return this->hash;
+    }
+
     ~Planet();
 
 private:
@@ -85,6 +175,14 @@ private:
 
     void set_poles();
 
+    void load_simulation();
+
+    void update_summary();
+
+    void load_borders();
+
+    void update_borders(unsigned int tile);
+
     Planet(Planet const&)          = delete;
     void operator=(Planet const&)  = delete;
 };
@@ -47,6 +47,14 @@ public:
         return this->size;
     }
 
+    inline unsigned int get_id() const {
+        return this->id;
+    }
+
+    inline const std::vector<Tile*>& get_neighbours() const {
+        return this->neighbours;
+    }
+
     inline void add_neighbour(Tile* tile) {
         this->neighbours.push_back(tile);
     }
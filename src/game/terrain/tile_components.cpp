@@ -0,0 +1,304 @@
+/**************************************************************************
+ *   tile_components.cpp  --  This file is part of Acardov.               *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "game/terrain/tile_components.h"
+
+/**
+ * @brief       find the root of a tile in a union-find forest (with path halving)
+ */
+static unsigned int find_root(std::vector<unsigned int>& parents, unsigned int tile) {
+    while(parents[tile] != tile) {
+        parents[tile] = parents[parents[tile]];
+        tile = parents[tile];
+    }
+    return tile;
+}
+
+/**
+ * @brief       merge two trees of a union-find forest, the smallest root wins
+ */
+static void unite(std::vector<unsigned int>& parents, unsigned int tile1, unsigned int tile2) {
+    const unsigned int root1 = find_root(parents, tile1);
+    const unsigned int root2 = find_root(parents, tile2);
+
+    if(root1 < root2) {
+        parents[root2] = root1;
+    } else if(root2 < root1) {
+        parents[root1] = root2;
+    }
+}
+
+/**
+ * @brief       construct a labelling where all tiles have key zero
+ *
+ * @param       _graph          adjacency of the tiles
+ */
+TileComponents::TileComponents(const TileRange* _graph) :
+    graph(_graph),
+    generation(0) {
+
+    const unsigned int nr_tiles = this->graph->get_nr_tiles();
+    this->stamps.assign(nr_tiles, 0);
+    this->queue.reserve(nr_tiles);
+    this->piece.reserve(nr_tiles);
+
+    const std::vector<unsigned int> zeros(nr_tiles, 0);
+    this->build(&zeros[0]);
+}
+
+/**
+ * @brief       label all tiles from scratch
+ *
+ * @param       _keys           array holding the key of every tile
+ */
+void TileComponents::build(const unsigned int* _keys) {
+    const unsigned int nr_tiles = this->graph->get_nr_tiles();
+    this->keys.assign(_keys, _keys + nr_tiles);
+
+    std::vector<unsigned int> parents(nr_tiles);
+    for(unsigned int i=0; i<nr_tiles; i++) {
+        parents[i] = i;
+    }
+
+    // unite the edges inside every range concurrently; the trees that are
+    // built by a job only contain tiles of its own range
+    const unsigned int nr_threads = JobSystem::get().get_nr_threads();
+    const unsigned int chunk = (nr_tiles + nr_threads - 1) / nr_threads;
+    JobSystem::get().parallel_for(0, nr_tiles, chunk, [this, &parents](size_t begin, size_t end) {
+        this->unite_range(&parents, begin, end);
+    });
+
+    // merge the trees over the edges that cross ranges
+    for(unsigned int i=0; i<nr_tiles; i++) {
+        const unsigned int range = i / chunk;
+        for(unsigned int neighbour: this->graph->get_neighbours(i)) {
+            if(neighbour > i && neighbour / chunk != range && this->keys[neighbour] == this->keys[i]) {
+                unite(parents, i, neighbour);
+            }
+        }
+    }
+
+    // assign consecutive labels to the roots
+    this->labels.assign(nr_tiles, 0);
+    this->sizes.clear();
+    this->free_labels.clear();
+    for(unsigned int i=0; i<nr_tiles; i++) {
+        const unsigned int root = find_root(parents, i);
+        if(root == i) {
+            this->labels[i] = this->sizes.size();
+            this->sizes.push_back(0);
+        } else {
+            // the root has the smallest id in its tree, hence is labelled before
+            this->labels[i] = this->labels[root];
+        }
+        this->sizes[this->labels[i]]++;
+    }
+    this->nr_components = this->sizes.size();
+}
+
+/**
+ * @brief       change the key of a single tile and relabel locally
+ *
+ * @param       tile            tile id
+ * @param       key             new key
+ */
+void TileComponents::set_key(unsigned int tile, unsigned int key) {
+    const unsigned int old_key = this->keys[tile];
+    const unsigned int old_label = this->labels[tile];
+    if(old_key == key) {
+        return;
+    }
+
+    this->keys[tile] = key;
+    const TileSet neighbours = this->graph->get_neighbours(tile);
+
+    // detach the tile from its former component
+    this->sizes[old_label]--;
+    if(this->sizes[old_label] == 0) {
+        this->release_label(old_label);
+    } else {
+        // the neighbours are stored in cyclic order and consecutive neighbours
+        // are adjacent; if the neighbours with the former key form a single arc,
+        // they remain connected to each other without this tile
+        unsigned int nr_arcs = 0;
+        for(unsigned int i=0; i<neighbours.size(); i++) {
+            const unsigned int prev = neighbours[(i + neighbours.size() - 1) % neighbours.size()];
+            if(this->keys[neighbours[i]] == old_key && this->keys[prev] != old_key) {
+                nr_arcs++;
+            }
+        }
+
+        if(nr_arcs > 1) {
+            // collect the pieces the former component fell apart in; the
+            // largest piece keeps the label
+            this->next_generation();
+            std::vector<std::vector<unsigned int> > pieces;
+            unsigned int largest = 0;
+            for(unsigned int neighbour: neighbours) {
+                if(this->keys[neighbour] == old_key && this->stamps[neighbour] != this->generation) {
+                    this->collect(neighbour);
+                    if(this->piece.size() == this->sizes[old_label]) {
+                        break;  // all tiles are reached from a single neighbour
+                    }
+                    if(!pieces.empty() && this->piece.size() > pieces[largest].size()) {
+                        largest = pieces.size();
+                    }
+                    pieces.push_back(this->piece);
+                }
+            }
+
+            for(unsigned int i=0; i<pieces.size(); i++) {
+                if(i == largest) {
+                    continue;
+                }
+                const unsigned int label = this->acquire_label();
+                for(unsigned int member: pieces[i]) {
+                    this->labels[member] = label;
+                }
+                this->sizes[label] = pieces[i].size();
+                this->sizes[old_label] -= pieces[i].size();
+            }
+        }
+    }
+
+    // attach the tile to the largest neighbouring component with the new key
+    unsigned int label = 0;
+    bool found = false;
+    for(unsigned int neighbour: neighbours) {
+        if(this->keys[neighbour] == key && (!found || this->sizes[this->labels[neighbour]] > this->sizes[label])) {
+            label = this->labels[neighbour];
+            found = true;
+        }
+    }
+
+    if(!found) {
+        label = this->acquire_label();
+    }
+    this->labels[tile] = label;
+    this->sizes[label]++;
+
+    // merge the other neighbouring components into it
+    for(unsigned int neighbour: neighbours) {
+        const unsigned int other = this->labels[neighbour];
+        if(this->keys[neighbour] == key && other != label) {
+            this->sizes[label] += this->sizes[other];
+            this->relabel(neighbour, label);
+            this->sizes[other] = 0;
+            this->release_label(other);
+        }
+    }
+}
+
+/**
+ * @brief       perform union-find over the edges that lie within a range of tiles
+ *
+ * @param       parents         union-find forest
+ * @param       begin           first tile
+ * @param       end             tile past the last one
+ */
+void TileComponents::unite_range(std::vector<unsigned int>* parents, unsigned int begin, unsigned int end) const {
+    for(unsigned int i=begin; i<end; i++) {
+        for(unsigned int neighbour: this->graph->get_neighbours(i)) {
+            if(neighbour > i && neighbour < end && this->keys[neighbour] == this->keys[i]) {
+                unite(*parents, i, neighbour);
+            }
+        }
+    }
+}
+
+/**
+ * @brief       get a label that is not in use
+ */
+unsigned int TileComponents::acquire_label() {
+    this->nr_components++;
+
+    if(this->free_labels.empty()) {
+        this->sizes.push_back(0);
+        return this->sizes.size() - 1;
+    }
+
+    const unsigned int label = this->free_labels.back();
+    this->free_labels.pop_back();
+    return label;
+}
+
+/**
+ * @brief       return a label that is no longer in use
+ */
+void TileComponents::release_label(unsigned int label) {
+    this->nr_components--;
+    this->free_labels.push_back(label);
+}
+
+/**
+ * @brief       relabel the component that contains a tile
+ *
+ * @param       tile            any tile in the component
+ * @param       label           new label
+ */
+void TileComponents::relabel(unsigned int tile, unsigned int label) {
+    const unsigned int old_label = this->labels[tile];
+
+    this->queue.clear();
+    this->queue.push_back(tile);
+    this->labels[tile] = label;
+    for(unsigned int i=0; i<this->queue.size(); i++) {
+        for(unsigned int neighbour: this->graph->get_neighbours(this->queue[i])) {
+            if(this->labels[neighbour] == old_label) {
+                this->labels[neighbour] = label;
+                this->queue.push_back(neighbour);
+            }
+        }
+    }
+}
+
+/**
+ * @brief       collect the tiles of a component into the piece buffer
+ *
+ * @param       tile            any tile in the component
+ */
+void TileComponents::collect(unsigned int tile) {
+    const unsigned int key = this->keys[tile];
+    const unsigned int label = this->labels[tile];
+
+    this->piece.clear();
+    this->piece.push_back(tile);
+    this->stamps[tile] = this->generation;
+    for(unsigned int i=0; i<this->piece.size(); i++) {
+        for(unsigned int neighbour: this->graph->get_neighbours(this->piece[i])) {
+            if(this->stamps[neighbour] != this->generation &&
+               this->keys[neighbour] == key && this->labels[neighbour] == label) {
+                this->stamps[neighbour] = this->generation;
+                this->piece.push_back(neighbour);
+            }
+        }
+    }
+}
+
+/**
+ * @brief       start a new flood fill generation
+ */
+void TileComponents::next_generation() {
+    this->generation++;
+    if(this->generation == 0) {
+        std::fill(this->stamps.begin(), this->stamps.end(), 0);
+        this->generation = 1;
+    }
+}
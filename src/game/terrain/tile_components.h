@@ -0,0 +1,158 @@
+/**************************************************************************
+ *   tile_components.h  --  This file is part of Acardov.                 *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _TILE_COMPONENTS_H
+#define _TILE_COMPONENTS_H
+
+#include <vector>
+#include <algorithm>
+
+#include "core/job_system.h"
+#include "game/terrain/tile_range.h"
+
+/**
+ * @class TileComponents
+ * @brief Labelling of the connected regions of tiles that share a key
+ *
+ * Every tile carries a key (e.g. the owner of the tile or its terrain
+ * class). Adjacent tiles with the same key belong to the same component.
+ * The initial labelling is done with a union-find pass that is run in
+ * parallel over ranges of tiles, after which the edges that cross ranges
+ * are merged serially. Afterwards, changing the key of a tile only
+ * relabels the components around that tile: merging relabels the smaller
+ * components and a flood fill is only required when the tile was a
+ * bridge between two parts of its former component.
+ */
+class TileComponents {
+private:
+    const TileRange* graph;                         //!< adjacency of the tiles
+
+    std::vector<unsigned int> keys;                 //!< key per tile
+    std::vector<unsigned int> labels;               //!< component label per tile
+    std::vector<unsigned int> sizes;                //!< number of tiles per label (zero for unused labels)
+    std::vector<unsigned int> free_labels;          //!< labels available for reuse
+    unsigned int nr_components;                     //!< number of components
+
+    std::vector<unsigned int> stamps;               //!< visit stamps for flood fills
+    unsigned int generation;                        //!< current stamp value
+    std::vector<unsigned int> queue;                //!< flood fill queue
+    std::vector<unsigned int> piece;                //!< tiles of the piece that is being collected
+
+public:
+    /**
+     * @brief       construct a labelling where all tiles have key zero
+     *
+     * @param       _graph          adjacency of the tiles
+     */
+    TileComponents(const TileRange* _graph);
+
+    /**
+     * @brief       label all tiles from scratch
+     *
+     * @param       _keys           array holding the key of every tile
+     */
+    void build(const unsigned int* _keys);
+
+    /**
+     * @brief       change the key of a single tile and relabel locally
+     *
+     * @param       tile            tile id
+     * @param       key             new key
+     */
+    void set_key(unsigned int tile, unsigned int key);
+
+    inline unsigned int get_key(unsigned int tile) const {
+        return this->keys[tile];
+    }
+
+    inline unsigned int get_label(unsigned int tile) const {
+        return this->labels[tile];
+    }
+
+    /**
+     * @brief       get the number of tiles in a component
+     *
+     * @param       label           component label
+     *
+     * @return      number of tiles
+     */
+    inline unsigned int get_size(unsigned int label) const {
+        return this->sizes[label];
+    }
+
+    inline unsigned int get_nr_components() const {
+        return this->nr_components;
+    }
+
+    /**
+     * @brief       whether two tiles belong to the same component
+     */
+    inline bool is_connected(unsigned int tile1, unsigned int tile2) const {
+        return this->labels[tile1] == this->labels[tile2];
+    }
+
+private:
+    /**
+     * @brief       perform union-find over the edges that lie within a range of tiles
+     *
+     * @param       parents         union-find forest
+     * @param       begin           first tile
+     * @param       end             tile past the last one
+     */
+    void unite_range(std::vector<unsigned int>* parents, unsigned int begin, unsigned int end) const;
+
+    /**
+     * @brief       get a label that is not in use
+     */
+    unsigned int acquire_label();
+
+    /**
+     * @brief       return a label that is no longer in use
+     */
+    void release_label(unsigned int label);
+
+    /**
+     * @brief       relabel the component that contains a tile
+     *
+     * @param       tile            any tile in the component
+     * @param       label           new label
+     */
+    void relabel(unsigned int tile, unsigned int label);
+
+    /**
+     * @brief       collect the tiles of a component into the piece buffer
+     *
+     * Only tiles that have not been stamped with the current generation are
+     * collected, such that consecutive calls partition a split component.
+     *
+     * @param       tile            any tile in the component
+     */
+    void collect(unsigned int tile);
+
+    /**
+     * @brief       start a new flood fill generation
+     */
+    void next_generation();
+
+    TileComponents(TileComponents const&)   = delete;
+    void operator=(TileComponents const&)   = delete;
+};
+
+#endif //_TILE_COMPONENTS_H
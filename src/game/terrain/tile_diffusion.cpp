@@ -0,0 +1,82 @@
+/**************************************************************************
+ *   tile_diffusion.cpp  --  This file is part of Acardov.                *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "game/terrain/tile_diffusion.h"
+
+/**
+ * @brief       assemble the Laplacian of the tile graph
+ *
+ * @param       graph       tile adjacency
+ * @param       _diffusion  diffusion coefficient per field (1/s)
+ * @param       _decay      decay rate per field (1/s)
+ */
+DiffusionRule::DiffusionRule(const TileRange& graph, const Coefficients& _diffusion, const Coefficients& _decay) :
+    diffusion(_diffusion),
+    decay(_decay) {
+
+    const unsigned int nr_tiles = graph.get_nr_tiles();
+
+    std::vector<Eigen::Triplet<float> > triplets;
+    triplets.reserve(nr_tiles * 7);
+    for(unsigned int i=0; i<nr_tiles; i++) {
+        const TileSet neighbours = graph.get_neighbours(i);
+        const float weight = 1.0f / (float)neighbours.size();
+
+        triplets.emplace_back(i, i, -1.0f);
+        for(unsigned int neighbour: neighbours) {
+            triplets.emplace_back(i, neighbour, weight);
+        }
+    }
+
+    this->laplacian.resize(nr_tiles, nr_tiles);
+    this->laplacian.setFromTriplets(triplets.begin(), triplets.end());
+    this->laplacian.makeCompressed();
+
+    this->scratch.resize(nr_tiles, NR_INFLUENCE_FIELDS);
+}
+
+void DiffusionRule::apply(const TileState& prev, TileState& next, const TileRange& graph, float dt, unsigned int begin, unsigned int end) const {
+    const unsigned int nr_tiles = prev.get_nr_tiles();
+    const unsigned int nr_rows = end - begin;
+
+    // view the consecutive influence arrays as a single (nr_tiles x 4) matrix
+    Eigen::Map<const Fields> x(prev.get_field(TileState::THREAT), nr_tiles, NR_INFLUENCE_FIELDS);
+    Eigen::Map<Fields, Eigen::Unaligned, Eigen::OuterStride<> > y(next.get_field(TileState::THREAT) + begin,
+                                                                  nr_rows, NR_INFLUENCE_FIELDS,
+                                                                  Eigen::OuterStride<>(nr_tiles));
+
+    // the amplification factors of the update are 1 - r + k * l, with l in
+    // [-2,0] the eigenvalues of the Laplacian; r + 2k <= 1 keeps them in
+    // [0,1], such that long ticks neither oscillate nor diverge. Both rates
+    // are scaled down together, preserving their ratio.
+    Coefficients k = this->diffusion * dt;
+    Coefficients r = this->decay * dt;
+    const Coefficients scale = (r + 2.0f * k).cwiseMax(1.0f);
+    k = k.cwiseQuotient(scale);
+    r = r.cwiseQuotient(scale);
+
+    // a single sparse product for all fields, into the rows of the scratch
+    // matrix owned by this partition; the rest is evaluated straight into
+    // the output
+    auto lx = this->scratch.middleRows(begin, nr_rows);
+    lx.noalias() = this->laplacian.middleRows(begin, nr_rows) * x;
+    y.noalias() = x.middleRows(begin, nr_rows) * (Coefficients::Ones() - r).asDiagonal();
+    y.noalias() += lx * k.asDiagonal();
+}
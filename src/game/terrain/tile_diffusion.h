@@ -0,0 +1,83 @@
+/**************************************************************************
+ *   tile_diffusion.h  --  This file is part of Acardov.                  *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _TILE_DIFFUSION_H
+#define _TILE_DIFFUSION_H
+
+#include <Eigen/Sparse>
+
+#include "game/terrain/tile_rule.h"
+
+/**
+ * @class DiffusionRule
+ * @brief Diffusion and decay of the influence fields over the tile graph
+ *
+ * The graph Laplacian L = D^-1 A - I (A the adjacency matrix and D the degree
+ * matrix) is assembled once. Because the influence fields are stored in
+ * consecutive arrays, they form a single column-major (nr_tiles x 4) matrix
+ * X and all fields are advanced using one sparse matrix product per tick:
+ *
+ *     X' = X + dt * (L X K - X R)
+ *
+ * wherein K and R are diagonal matrices holding the diffusion and decay
+ * coefficient of every field. The eigenvalues of L lie in [-2,0], such that
+ * the explicit update neither oscillates nor diverges as long as
+ * dt * (r + 2k) <= 1; longer ticks scale both rates down to that bound.
+ *
+ * The product L X is evaluated into a scratch matrix that is allocated
+ * once; the partitions of a step write disjoint rows of it.
+ */
+class DiffusionRule : public TileRule {
+public:
+    enum {
+        NR_INFLUENCE_FIELDS = TileState::TEMPERATURE - TileState::THREAT + 1
+    };
+
+    typedef Eigen::Matrix<float, NR_INFLUENCE_FIELDS, 1> Coefficients;
+
+private:
+    typedef Eigen::Matrix<float, Eigen::Dynamic, NR_INFLUENCE_FIELDS> Fields;
+
+    Eigen::SparseMatrix<float, Eigen::RowMajor> laplacian;  //!< random-walk graph Laplacian
+    mutable Fields scratch;                                 //!< L X, every partition owns its rows
+    Coefficients diffusion;                                 //!< diffusion coefficient per field
+    Coefficients decay;                                     //!< decay rate per field
+
+public:
+    /**
+     * @brief       assemble the Laplacian of the tile graph
+     *
+     * @param       graph       tile adjacency
+     * @param       _diffusion  diffusion coefficient per field (1/s)
+     * @param       _decay      decay rate per field (1/s)
+     */
+    DiffusionRule(const TileRange& graph, const Coefficients& _diffusion, const Coefficients& _decay);
+
+    unsigned int get_output_mask() const {
+        return (1 << TileState::THREAT) | (1 << TileState::CULTURE) |
+               (1 << TileState::SUPPLY) | (1 << TileState::TEMPERATURE);
+    }
+
+    void apply(const TileState& prev, TileState& next, const TileRange& graph, float dt, unsigned int begin, unsigned int end) const;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+#endif //_TILE_DIFFUSION_H
@@ -0,0 +1,205 @@
+/**************************************************************************
+ *   tile_range.cpp  --  This file is part of Acardov.                    *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "game/terrain/tile_range.h"
+
+/**
+ * @brief       build the range query structures from the tiles of a planet
+ *
+ * @param       tiles       vector holding the tiles
+ */
+TileRange::TileRange(const std::vector<std::unique_ptr<Tile> >& tiles) {
+    const unsigned int nr_tiles = tiles.size();
+
+    this->adjacency_offsets.reserve(nr_tiles + 1);
+    this->adjacency_offsets.push_back(0);
+    for(auto&& tile: tiles) {
+        for(const Tile* neighbour: tile->get_neighbours()) {
+            this->adjacency.push_back(neighbour->get_id());
+        }
+        this->adjacency_offsets.push_back(this->adjacency.size());
+    }
+
+    this->stamps.resize(nr_tiles, 0);
+    this->generation = 1;
+
+    // reserve sufficient space such that a query never has to allocate
+    this->frontier.reserve(nr_tiles);
+    this->levels.reserve(nr_tiles + 2);
+
+    this->build_ring2();
+}
+
+/**
+ * @brief       get all tiles at most k steps away from a tile (including the tile itself)
+ *
+ * @param       center      id of the central tile
+ * @param       k           radius in steps
+ *
+ * @return      set of tile ids, ordered by distance to the center
+ */
+TileSet TileRange::disc(unsigned int center, unsigned int k) {
+    this->next_generation();
+
+    if(k > 2) {
+        this->visit(center);
+        this->expand(k);
+    } else {
+        // use the precomputed rings for small radii
+        this->visit(center);
+        this->levels.push_back(this->frontier.size());
+
+        if(k > 0) {
+            for(unsigned int i=this->adjacency_offsets[center]; i<this->adjacency_offsets[center+1]; i++) {
+                this->visit(this->adjacency[i]);
+            }
+            this->levels.push_back(this->frontier.size());
+        }
+
+        if(k > 1) {
+            for(unsigned int i=this->ring2_offsets[center]; i<this->ring2_offsets[center+1]; i++) {
+                this->visit(this->ring2[i]);
+            }
+            this->levels.push_back(this->frontier.size());
+        }
+    }
+
+    return TileSet(&this->frontier[0], &this->frontier[0] + this->frontier.size());
+}
+
+/**
+ * @brief       get all tiles exactly k steps away from a tile
+ *
+ * @param       center      id of the central tile
+ * @param       k           radius in steps
+ *
+ * @return      set of tile ids
+ */
+TileSet TileRange::ring(unsigned int center, unsigned int k) {
+    this->disc(center, k);
+
+    // the search ends early when the whole planet is covered
+    if(k + 1 >= this->levels.size()) {
+        return TileSet(&this->frontier[0], &this->frontier[0]);
+    }
+
+    return TileSet(&this->frontier[0] + this->levels[k], &this->frontier[0] + this->levels[k+1]);
+}
+
+/**
+ * @brief       get the union of the discs of radius k around many tiles
+ *
+ * @param       centers     pointer to array of center tile ids
+ * @param       nr_centers  number of centers
+ * @param       k           radius in steps
+ *
+ * @return      set of tile ids
+ */
+TileSet TileRange::discs(const unsigned int* centers, size_t nr_centers, unsigned int k) {
+    this->next_generation();
+
+    for(size_t i=0; i<nr_centers; i++) {
+        this->visit(centers[i]);
+    }
+    this->expand(k);
+
+    if(this->frontier.empty()) {
+        return TileSet(NULL, NULL);
+    }
+
+    return TileSet(&this->frontier[0], &this->frontier[0] + this->frontier.size());
+}
+
+/**
+ * @brief       start a new query by increasing the generation
+ */
+void TileRange::next_generation() {
+    this->generation++;
+
+    // upon overflow, the stamps have to be cleared once
+    if(this->generation == 0) {
+        std::fill(this->stamps.begin(), this->stamps.end(), 0);
+        this->generation = 1;
+    }
+
+    this->frontier.clear();
+    this->levels.clear();
+    this->levels.push_back(0);
+}
+
+/**
+ * @brief       expand the frontier breadth-first until radius k is reached
+ *
+ * On return, ring d of the search is stored in the frontier buffer between
+ * positions levels[d] and levels[d+1].
+ *
+ * @param       k           radius in steps
+ */
+void TileRange::expand(unsigned int k) {
+    for(unsigned int d=0; d<k; d++) {
+        const unsigned int ring_start = this->levels.back();
+        const unsigned int ring_end = this->frontier.size();
+        this->levels.push_back(ring_end);
+
+        for(unsigned int j=ring_start; j<ring_end; j++) {
+            const unsigned int tile = this->frontier[j];
+            for(unsigned int i=this->adjacency_offsets[tile]; i<this->adjacency_offsets[tile+1]; i++) {
+                this->visit(this->adjacency[i]);
+            }
+        }
+
+        // the complete planet has been covered
+        if(this->frontier.size() == ring_end) {
+            return;
+        }
+    }
+
+    this->levels.push_back(this->frontier.size());
+}
+
+/**
+ * @brief       store the tiles exactly two steps away of every tile
+ */
+void TileRange::build_ring2() {
+    const unsigned int nr_tiles = this->stamps.size();
+
+    this->ring2_offsets.reserve(nr_tiles + 1);
+    this->ring2_offsets.push_back(0);
+    this->ring2.reserve(this->adjacency.size() * 2);
+
+    for(unsigned int tile=0; tile<nr_tiles; tile++) {
+        this->next_generation();
+        this->visit(tile);
+        this->expand(1);
+
+        for(unsigned int j=this->levels[1]; j<this->frontier.size(); j++) {
+            const unsigned int neighbour = this->frontier[j];
+            for(unsigned int i=this->adjacency_offsets[neighbour]; i<this->adjacency_offsets[neighbour+1]; i++) {
+                const unsigned int other = this->adjacency[i];
+                if(this->stamps[other] != this->generation) {
+                    this->stamps[other] = this->generation;
+                    this->ring2.push_back(other);
+                }
+            }
+        }
+
+        this->ring2_offsets.push_back(this->ring2.size());
+    }
+}
@@ -0,0 +1,196 @@
+/**************************************************************************
+ *   tile_range.h  --  This file is part of Acardov.                      *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _TILE_RANGE_H
+#define _TILE_RANGE_H
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+
+#include "game/terrain/tile.h"
+
+/**
+ * @class TileSet
+ * @brief Read-only view on a contiguous list of tile ids
+ *
+ * A TileSet does not own its data; it points into the buffers of the
+ * TileRange that produced it and is only valid until the next query.
+ */
+class TileSet {
+private:
+    const unsigned int* first;      //!< pointer to the first tile id
+    const unsigned int* last;       //!< pointer past the last tile id
+
+public:
+    TileSet(const unsigned int* _first, const unsigned int* _last) :
+        first(_first),
+        last(_last) {}
+
+    inline const unsigned int* begin() const {
+        return this->first;
+    }
+
+    inline const unsigned int* end() const {
+        return this->last;
+    }
+
+    inline size_t size() const {
+        return this->last - this->first;
+    }
+
+    inline bool empty() const {
+        return this->first == this->last;
+    }
+
+    inline unsigned int operator[](size_t i) const {
+        return this->first[i];
+    }
+};
+
+/**
+ * @class TileRange
+ * @brief Answers "which tiles are within k steps of tile T" queries
+ *
+ * The tile graph is stored in compressed (CSR) form. Breadth-first searches
+ * use a generation-stamped visited array, so that no clearing is required in
+ * between queries, and a single frontier buffer that is reserved for all tiles
+ * at construction; hence queries never allocate. The discs of radius one and
+ * two are precomputed, because these are by far the most common requests
+ * (adjacent tiles, short movement and attack ranges).
+ *
+ * A TileRange is not thread-safe; every thread should use its own copy.
+ */
+class TileRange {
+private:
+    std::vector<unsigned int> adjacency_offsets;    //!< offsets into adjacency per tile (nr_tiles + 1 entries)
+    std::vector<unsigned int> adjacency;            //!< flattened list of neighbouring tiles
+
+    std::vector<unsigned int> ring2_offsets;        //!< offsets into ring2 per tile (nr_tiles + 1 entries)
+    std::vector<unsigned int> ring2;                //!< flattened list of tiles exactly two steps away
+
+    std::vector<unsigned int> stamps;               //!< generation stamp of the last visit per tile
+    unsigned int generation;                        //!< current generation
+
+    std::vector<unsigned int> frontier;             //!< breadth-first search buffer, holds the result of a query
+    std::vector<unsigned int> levels;               //!< start position of each ring in the frontier buffer
+
+public:
+    /**
+     * @brief       build the range query structures from the tiles of a planet
+     *
+     * @param       tiles       vector holding the tiles
+     */
+    TileRange(const std::vector<std::unique_ptr<Tile> >& tiles);
+
+    /**
+     * @brief       get all tiles at most k steps away from a tile (including the tile itself)
+     *
+     * @param       center      id of the central tile
+     * @param       k           radius in steps
+     *
+     * @return      set of tile ids, ordered by distance to the center
+     */
+    TileSet disc(unsigned int center, unsigned int k);
+
+    /**
+     * @brief       get all tiles exactly k steps away from a tile
+     *
+     * @param       center      id of the central tile
+     * @param       k           radius in steps
+     *
+     * @return      set of tile ids
+     */
+    TileSet ring(unsigned int center, unsigned int k);
+
+    /**
+     * @brief       get the union of the discs of radius k around many tiles
+     *
+     * All centers are expanded simultaneously, such that every tile is visited
+     * at most once, irrespective of how much the discs overlap.
+     *
+     * @param       centers     pointer to array of center tile ids
+     * @param       nr_centers  number of centers
+     * @param       k           radius in steps
+     *
+     * @return      set of tile ids
+     */
+    TileSet discs(const unsigned int* centers, size_t nr_centers, unsigned int k);
+
+    /**
+     * @brief       check whether a tile is part of the result of the last query
+     *
+     * @param       tile        tile id
+     *
+     * @return      whether the tile was found
+     */
+    inline bool is_marked(unsigned int tile) const {
+        return this->stamps[tile] == this->generation;
+    }
+
+    /**
+     * @brief       get the neighbours of a tile
+     *
+     * @param       tile        tile id
+     *
+     * @return      set of neighbouring tile ids
+     */
+    inline TileSet get_neighbours(unsigned int tile) const {
+        return TileSet(&this->adjacency[0] + this->adjacency_offsets[tile],
+                       &this->adjacency[0] + this->adjacency_offsets[tile+1]);
+    }
+
+    inline unsigned int get_nr_tiles() const {
+        return this->stamps.size();
+    }
+
+private:
+    /**
+     * @brief       start a new query by increasing the generation
+     */
+    void next_generation();
+
+    /**
+     * @brief       mark a tile as visited and push it to the frontier
+     *
+     * @param       tile        tile id
+     */
+    inline void visit(unsigned int tile) {
+        if(this->stamps[tile] != this->generation) {
+            this->stamps[tile] = this->generation;
+            this->frontier.push_back(tile);
+        }
+    }
+
+    /**
+     * @brief       expand the frontier breadth-first until radius k is reached
+     *
+     * @param       k           radius in steps
+     */
+    void expand(unsigned int k);
+
+    /**
+     * @brief       store the tiles exactly two steps away of every tile
+     */
+    void build_ring2();
+};
+
+#endif //_TILE_RANGE_H
@@ -0,0 +1,58 @@
+/**************************************************************************
+ *   tile_rule.cpp  --  This file is part of Acardov.                     *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "game/terrain/tile_rule.h"
+
+void ResourceGrowthRule::apply(const TileState& prev, TileState& next, const TileRange& graph, float dt, unsigned int begin, unsigned int end) const {
+    const float* resources = prev.get_field(TileState::RESOURCES);
+    const float* fire = prev.get_field(TileState::FIRE);
+    float* resources_next = next.get_field(TileState::RESOURCES);
+
+    const float inv_capacity = 1.0f / this->capacity;
+    for(unsigned int i=begin; i<end; i++) {
+        const float growth = this->rate * resources[i] * (1.0f - resources[i] * inv_capacity);
+        resources_next[i] = std::max(0.0f, resources[i] + dt * growth * (1.0f - fire[i]));
+    }
+}
+
+void FireSpreadRule::apply(const TileState& prev, TileState& next, const TileRange& graph, float dt, unsigned int begin, unsigned int end) const {
+    const float* fire = prev.get_field(TileState::FIRE);
+    const float* fuel = prev.get_field(TileState::FUEL);
+    float* fire_next = next.get_field(TileState::FIRE);
+    float* fuel_next = next.get_field(TileState::FUEL);
+
+    for(unsigned int i=begin; i<end; i++) {
+        if(fuel[i] > 0.0f) {
+            // average fire intensity of the neighbouring tiles
+            const TileSet neighbours = graph.get_neighbours(i);
+            float sum = 0.0f;
+            for(unsigned int neighbour: neighbours) {
+                sum += fire[neighbour];
+            }
+            const float exposure = sum / (float)neighbours.size();
+
+            fire_next[i] = std::min(1.0f, fire[i] + dt * this->spread * exposure * fuel[i]);
+            fuel_next[i] = std::max(0.0f, fuel[i] - dt * this->burn * fire[i]);
+        } else {
+            fire_next[i] = std::max(0.0f, fire[i] - dt * this->decay);
+            fuel_next[i] = 0.0f;
+        }
+    }
+}
@@ -0,0 +1,106 @@
+/**************************************************************************
+ *   tile_rule.h  --  This file is part of Acardov.                       *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _TILE_RULE_H
+#define _TILE_RULE_H
+
+#include <algorithm>
+
+#include "game/terrain/tile_state.h"
+#include "game/terrain/tile_range.h"
+
+/**
+ * @class TileRule
+ * @brief Cellular update rule of the tile simulation
+ *
+ * A rule reads the previous state and writes the next state of the fields it
+ * owns. Because the previous state is never written during a step, a rule can
+ * be applied to disjoint ranges of tiles concurrently. Every field should be
+ * owned by at most one rule; fields that are owned by no rule are carried over.
+ */
+class TileRule {
+public:
+    /**
+     * @brief       get the fields this rule writes to
+     *
+     * @return      bitmask of field ids (1 << TileState::FIELD)
+     */
+    virtual unsigned int get_output_mask() const = 0;
+
+    /**
+     * @brief       advance a range of tiles by a single tick
+     *
+     * @param       prev        state at the start of the tick (read-only)
+     * @param       next        state at the end of the tick
+     * @param       graph       tile adjacency
+     * @param       dt          duration of the tick
+     * @param       begin       first tile
+     * @param       end         tile past the last one
+     */
+    virtual void apply(const TileState& prev, TileState& next, const TileRange& graph, float dt, unsigned int begin, unsigned int end) const = 0;
+
+    virtual ~TileRule() {}
+};
+
+/**
+ * @class ResourceGrowthRule
+ * @brief Logistic growth of resources, suppressed by fire
+ */
+class ResourceGrowthRule : public TileRule {
+private:
+    float rate;         //!< growth rate per second
+    float capacity;     //!< maximum amount of resources on a tile
+
+public:
+    ResourceGrowthRule(float _rate, float _capacity) :
+        rate(_rate),
+        capacity(_capacity) {}
+
+    unsigned int get_output_mask() const {
+        return (1 << TileState::RESOURCES);
+    }
+
+    void apply(const TileState& prev, TileState& next, const TileRange& graph, float dt, unsigned int begin, unsigned int end) const;
+};
+
+/**
+ * @class FireSpreadRule
+ * @brief Fire that spreads to neighbouring tiles while consuming fuel
+ */
+class FireSpreadRule : public TileRule {
+private:
+    float spread;       //!< rate at which fire jumps over from burning neighbours
+    float burn;         //!< rate at which fuel is consumed
+    float decay;        //!< rate at which fire dies out without fuel
+
+public:
+    FireSpreadRule(float _spread, float _burn, float _decay) :
+        spread(_spread),
+        burn(_burn),
+        decay(_decay) {}
+
+    unsigned int get_output_mask() const {
+        return (1 << TileState::FIRE) | (1 << TileState::FUEL);
+    }
+
+    void apply(const TileState& prev, TileState& next, const TileRange& graph, float dt, unsigned int begin, unsigned int end) const;
+};
+
+#endif //_TILE_RULE_H
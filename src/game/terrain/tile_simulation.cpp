@@ -0,0 +1,199 @@
+/**************************************************************************
+ *   tile_simulation.cpp  --  This file is part of Acardov.               *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "game/terrain/tile_simulation.h"
+
+#include <algorithm>
+
+/**
+ * @brief       simulation constructor
+ *
+ * @param       _graph          adjacency of the tiles
+ * @param       tick_rate       number of ticks per second
+ */
+TileSimulation::TileSimulation(const TileRange* _graph, double tick_rate) :
+    graph(_graph),
+    state_prev(new TileState(_graph->get_nr_tiles())),
+    state_next(new TileState(_graph->get_nr_tiles())),
+    output_mask(0),
+    tick(1.0 / tick_rate),
+    accumulator(0.0),
+    nr_ticks(0) {
+
+    this->nr_partitions = JobSystem::get().get_nr_threads();
+}
+
+/**
+ * @brief       add an update rule, the simulation takes ownership
+ *
+ * @param       rule            pointer to the rule
+ */
+void TileSimulation::add_rule(TileRule* rule) {
+    this->finish();
+    this->rules.emplace_back(rule);
+    this->output_mask |= rule->get_output_mask();
+}
+
+/**
+ * @brief       advance the simulation clock
+ *
+ * @param       dt              elapsed time in seconds
+ */
+void TileSimulation::update(double dt) {
+    this->accumulator += dt;
+
+    while(this->accumulator >= this->tick) {
+        this->accumulator -= this->tick;
+
+        this->finish();
+        this->apply_edits();
+        this->start_step();
+    }
+}
+
+/**
+ * @brief       perform a single tick synchronously
+ */
+void TileSimulation::step() {
+    this->finish();
+    this->apply_edits();
+    this->start_step();
+    this->finish();
+}
+
+/**
+ * @brief       wait for the step in flight (if any) and publish its result
+ */
+void TileSimulation::finish() {
+    if(this->jobs.empty()) {
+        return;
+    }
+
+    JobSystem::get().wait(this->jobs);
+    this->jobs.clear();
+
+    std::swap(this->state_prev, this->state_next);
+    this->nr_ticks++;
+}
+
+/**
+ * @brief       finish the step in flight and apply the queued edits
+ */
+void TileSimulation::synchronize() {
+    this->finish();
+    this->apply_edits();
+}
+
+/**
+ * @brief       queue a modification of a tile value for the next tick boundary
+ *
+ * @param       field           field id
+ * @param       tile            tile id
+ * @param       value           new value
+ */
+void TileSimulation::set_value(unsigned int field, unsigned int tile, float value) {
+    TileEdit edit;
+    edit.field = field;
+    edit.tile = tile;
+    edit.value = value;
+    this->edits.push_back(edit);
+}
+
+/**
+ * @brief       set a field of all tiles to a single value immediately
+ *
+ * @param       field           field id
+ * @param       value           new value
+ */
+void TileSimulation::fill(unsigned int field, float value) {
+    this->finish();
+
+    float* values = this->state_prev->get_field(field);
+    std::fill(values, values + this->state_prev->get_nr_tiles(), value);
+}
+
+/**
+ * @brief       replace the state, e.g. when loading a saved game
+ *
+ * @param       fields          values of all fields (one array per field)
+ * @param       tick            tick number of the state
+ */
+void TileSimulation::restore(const float* fields, unsigned long int tick) {
+    this->finish();
+    this->edits.clear();
+
+    const unsigned int nr_tiles = this->state_prev->get_nr_tiles();
+    for(unsigned int field=0; field<TileState::NR_FIELDS; field++) {
+        std::copy(fields + field * nr_tiles, fields + (field + 1) * nr_tiles, this->state_prev->get_field(field));
+    }
+
+    this->nr_ticks = tick;
+    this->accumulator = 0.0;
+}
+
+TileSimulation::~TileSimulation() {
+    this->finish();
+}
+
+/**
+ * @brief       launch the computation of the next state on the workers
+ */
+void TileSimulation::start_step() {
+    const unsigned int nr_tiles = this->state_prev->get_nr_tiles();
+    const unsigned int chunk = (nr_tiles + this->nr_partitions - 1) / this->nr_partitions;
+
+    for(unsigned int begin=0; begin<nr_tiles; begin+=chunk) {
+        const unsigned int end = std::min(begin + chunk, nr_tiles);
+        this->jobs.push_back(JobSystem::get().submit([this, begin, end]() {
+            this->run_partition(begin, end);
+        }));
+    }
+}
+
+/**
+ * @brief       advance a contiguous range of tiles by a single tick
+ *
+ * @param       begin           first tile
+ * @param       end             tile past the last one
+ */
+void TileSimulation::run_partition(unsigned int begin, unsigned int end) {
+    const float dt = (float)this->tick;
+
+    for(auto&& rule: this->rules) {
+        rule->apply(*this->state_prev, *this->state_next, *this->graph, dt, begin, end);
+    }
+
+    // carry over the fields that are not owned by any rule
+    for(unsigned int field=0; field<TileState::NR_FIELDS; field++) {
+        if(!(this->output_mask & (1 << field))) {
+            this->state_next->copy_field(*this->state_prev, field, begin, end);
+        }
+    }
+}
+
+/**
+ * @brief       write the queued modifications to the visible state
+ */
+void TileSimulation::apply_edits() {
+    for(const TileEdit& edit: this->edits) {
+        this->state_prev->get_field(edit.field)[edit.tile] = edit.value;
+    }
+    this->edits.clear();
+}
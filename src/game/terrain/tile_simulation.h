@@ -0,0 +1,200 @@
+/**************************************************************************
+ *   tile_simulation.h  --  This file is part of Acardov.                 *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _TILE_SIMULATION_H
+#define _TILE_SIMULATION_H
+
+#include <vector>
+#include <memory>
+
+#include "core/job_system.h"
+
+#include "game/terrain/tile_state.h"
+#include "game/terrain/tile_rule.h"
+#include "game/terrain/tile_range.h"
+
+/**
+ * @class TileSimulation
+ * @brief Fixed-rate, double-buffered stepper for cellular processes on tiles
+ *
+ * The simulation holds two TileState buffers. The previous state is what the
+ * rest of the game reads; the next state is written by the step that is in
+ * flight. A step is partitioned by tile range into jobs for the job system
+ * and runs in the background while frames are rendered. At the following tick
+ * boundary the step is joined and the buffers are swapped, hence the visible
+ * state always lags one tick behind the computation.
+ *
+ * External modifications are queued and applied at the next tick boundary,
+ * such that they never race with a running step.
+ */
+class TileSimulation {
+private:
+    /**
+     * @struct TileEdit
+     * @brief  queued modification of a single tile value
+     */
+    struct TileEdit {
+        unsigned int field;     //!< field id
+        unsigned int tile;      //!< tile id
+        float value;            //!< new value
+    };
+
+    const TileRange* graph;                         //!< adjacency of the tiles
+    std::unique_ptr<TileState> state_prev;          //!< last completed state (visible to the game)
+    std::unique_ptr<TileState> state_next;          //!< state being computed
+
+    std::vector<std::unique_ptr<TileRule> > rules;  //!< update rules
+    unsigned int output_mask;                       //!< fields written by any of the rules
+
+    std::vector<TileEdit> edits;                    //!< pending modifications
+
+    double tick;                                    //!< duration of a single tick in seconds
+    double accumulator;                             //!< time not yet consumed by ticks
+    unsigned long int nr_ticks;                     //!< number of completed ticks
+
+    unsigned int nr_partitions;                     //!< number of jobs a step is divided over
+    std::vector<JobHandle> jobs;                    //!< jobs of the step in flight
+
+public:
+    /**
+     * @brief       simulation constructor
+     *
+     * @param       _graph          adjacency of the tiles
+     * @param       tick_rate       number of ticks per second
+     */
+    TileSimulation(const TileRange* _graph, double tick_rate);
+
+    /**
+     * @brief       add an update rule, the simulation takes ownership
+     *
+     * @param       rule            pointer to the rule
+     */
+    void add_rule(TileRule* rule);
+
+    /**
+     * @brief       advance the simulation clock
+     *
+     * Completes a tick for every tick interval that has passed. Completing a
+     * tick means joining the step in flight, swapping the buffers and starting
+     * the computation of the next step.
+     *
+     * @param       dt              elapsed time in seconds
+     */
+    void update(double dt);
+
+    /**
+     * @brief       perform a single tick synchronously
+     */
+    void step();
+
+    /**
+     * @brief       wait for the step in flight (if any) and publish its result
+     */
+    void finish();
+
+    /**
+     * @brief       finish the step in flight and apply the queued edits
+     *
+     * With no step in flight, the edits end up in the same state as they
+     * would at the next tick boundary, so the outcome does not change.
+     */
+    void synchronize();
+
+    /**
+     * @brief       queue a modification of a tile value for the next tick boundary
+     *
+     * @param       field           field id
+     * @param       tile            tile id
+     * @param       value           new value
+     */
+    void set_value(unsigned int field, unsigned int tile, float value);
+
+    /**
+     * @brief       set a field of all tiles to a single value immediately
+     *
+     * @param       field           field id
+     * @param       value           new value
+     */
+    void fill(unsigned int field, float value);
+
+    /**
+     * @brief       replace the state, e.g. when loading a saved game
+     *
+     * Pending modifications are discarded.
+     *
+     * @param       fields          values of all fields (one array per field)
+     * @param       tick            tick number of the state
+     */
+    void restore(const float* fields, unsigned long int tick);
+
+    /**
+     * @brief       get the last completed state
+     *
+     * @return      reference to the state
+     */
+    inline const TileState& get_state() const {
+        return *this->state_prev;
+    }
+
+    inline unsigned long int get_nr_ticks() const {
+        return this->nr_ticks;
+    }
+
+    inline double get_accumulator() const {
+        return this->accumulator;
+    }
+
+    /**
+     * @brief       set the time not yet consumed by ticks, e.g. when restoring a replay keyframe
+     */
+    inline void set_accumulator(double _accumulator) {
+        this->accumulator = _accumulator;
+    }
+
+    inline bool is_running() const {
+        return !this->jobs.empty();
+    }
+
+    ~TileSimulation();
+
+private:
+    /**
+     * @brief       launch the computation of the next state on the workers
+     */
+    void start_step();
+
+    /**
+     * @brief       advance a contiguous range of tiles by a single tick
+     *
+     * @param       begin           first tile
+     * @param       end             tile past the last one
+     */
+    void run_partition(unsigned int begin, unsigned int end);
+
+    /**
+     * @brief       write the queued modifications to the visible state
+     */
+    void apply_edits();
+
+    TileSimulation(TileSimulation const&)     = delete;
+    void operator=(TileSimulation const&)     = delete;
+};
+
+#endif //_TILE_SIMULATION_H
@@ -1,5 +1,5 @@
 /**************************************************************************
- *   piece.h  --  This file is part of Acardov.                           *
+ *   tile_state.cpp  --  This file is part of Acardov.                    *
  *                                                                        *
  *   Copyright (C) 2016, Ivo Filot                                        *
  *                                                                        *
@@ -18,37 +18,14 @@
  *                                                                        *
  **************************************************************************/
 
-#ifndef _PIECE_H
-#define _PIECE_H
-
-#include "game/terrain/tile.h"
-#include "core/shader.h"
-#include "models/mesh.h"
-#include "util/mathfunc.h"
-#include "core/light.h"
-
-class Piece {
-private:
-    std::vector<Mesh*> meshes;
-    const Tile* tile;
-    Shader* shader;
-    std::vector<glm::vec3> colors;
-
-public:
-    Piece(Shader* _shader);
-
-    void draw();
-
-    inline void add_mesh(Mesh* mesh, const glm::vec3& color) {
-        this->meshes.push_back(mesh);
-        this->colors.push_back(color);
-    }
-
-    inline void set_tile(const Tile* _tile) {
-        this->tile = _tile;
-    }
-
-private:
-};
-
-#endif // PIECE_H
+#include "game/terrain/tile_state.h"
+
+/**
+ * @brief       construct the state for a number of tiles
+ *
+ * @param       _nr_tiles   number of tiles
+ */
+TileState::TileState(unsigned int _nr_tiles) :
+    nr_tiles(_nr_tiles),
+    fields(_nr_tiles * NR_FIELDS, 0.0f) {
+}
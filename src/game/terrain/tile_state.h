@@ -0,0 +1,90 @@
+/**************************************************************************
+ *   tile_state.h  --  This file is part of Acardov.                      *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _TILE_STATE_H
+#define _TILE_STATE_H
+
+#include <vector>
+#include <cstring>
+
+/**
+ * @class TileState
+ * @brief Per-tile simulation state stored as one array per quantity (SoA)
+ */
+class TileState {
+private:
+    unsigned int nr_tiles;                          //!< number of tiles
+    std::vector<float> fields;                      //!< all fields, stored back-to-back
+
+public:
+    enum {
+        RESOURCES,      //!< amount of resources on the tile
+        FUEL,           //!< amount of burnable material
+        FIRE,           //!< fire intensity between 0 and 1
+
+        // influence fields, these need to be consecutive (see DiffusionRule)
+        THREAT,         //!< military threat
+        CULTURE,        //!< cultural influence
+        SUPPLY,         //!< reach of the supply network
+        TEMPERATURE,    //!< temperature
+
+        NR_FIELDS
+    };
+
+    /**
+     * @brief       construct the state for a number of tiles
+     *
+     * @param       _nr_tiles   number of tiles
+     */
+    TileState(unsigned int _nr_tiles);
+
+    inline unsigned int get_nr_tiles() const {
+        return this->nr_tiles;
+    }
+
+    /**
+     * @brief       get the values of a single field for all tiles
+     *
+     * @param       field       field id (see enum above)
+     *
+     * @return      pointer to the array of values
+     */
+    inline float* get_field(unsigned int field) {
+        return &this->fields[field * this->nr_tiles];
+    }
+
+    inline const float* get_field(unsigned int field) const {
+        return &this->fields[field * this->nr_tiles];
+    }
+
+    /**
+     * @brief       copy part of a field from another state
+     *
+     * @param       other       state to copy from
+     * @param       field       field id
+     * @param       begin       first tile
+     * @param       end         tile past the last one
+     */
+    inline void copy_field(const TileState& other, unsigned int field, unsigned int begin, unsigned int end) {
+        std::memcpy(this->get_field(field) + begin, other.get_field(field) + begin, (end - begin) * sizeof(float));
+    }
+};
+
+#endif //_TILE_STATE_H
@@ -0,0 +1,168 @@
+/**************************************************************************
+ *   tile_summary.cpp  --  This file is part of Acardov.                  *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "game/terrain/tile_summary.h"
+
+/**
+ * @brief       construct the summary tree
+ *
+ * @param       _parents        parent of each tile at the previous level
+ * @param       _level_sizes    number of tiles per level
+ * @param       _nr_channels    number of quantities to summarize
+ */
+TileSummary::TileSummary(const std::vector<unsigned int>& _parents,
+                         const std::vector<unsigned int>& _level_sizes,
+                         unsigned int _nr_channels) :
+    nr_channels(_nr_channels),
+    parents(_parents),
+    level_sizes(_level_sizes) {
+
+    const unsigned int nr_levels = this->level_sizes.size();
+
+    // collect the children of every node, a node is always its own first child
+    this->child_offsets.resize(nr_levels - 1);
+    this->children.resize(nr_levels - 1);
+    for(unsigned int l=0; l<nr_levels-1; l++) {
+        const unsigned int nr_nodes = this->level_sizes[l];
+        const unsigned int nr_fine = this->level_sizes[l+1];
+
+        std::vector<unsigned int>& offsets = this->child_offsets[l];
+        offsets.assign(nr_nodes + 1, 0);
+        for(unsigned int i=0; i<nr_nodes; i++) {
+            offsets[i+1]++;
+        }
+        for(unsigned int i=nr_nodes; i<nr_fine; i++) {
+            offsets[this->parents[i]+1]++;
+        }
+        for(unsigned int i=0; i<nr_nodes; i++) {
+            offsets[i+1] += offsets[i];
+        }
+
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        this->children[l].resize(nr_fine);
+        for(unsigned int i=0; i<nr_nodes; i++) {
+            this->children[l][fill[i]++] = i;
+        }
+        for(unsigned int i=nr_nodes; i<nr_fine; i++) {
+            this->children[l][fill[this->parents[i]]++] = i;
+        }
+    }
+
+    Aggregate zero;
+    zero.sum = zero.min = zero.max = 0.0f;
+    this->aggregates.resize(nr_levels);
+    for(unsigned int l=0; l<nr_levels; l++) {
+        this->aggregates[l].assign(this->nr_channels * this->level_sizes[l], zero);
+    }
+}
+
+/**
+ * @brief       set the value of a single tile and update its ancestors
+ *
+ * @param       channel     channel id
+ * @param       tile        tile id
+ * @param       value       new value
+ */
+void TileSummary::set_value(unsigned int channel, unsigned int tile, float value) {
+    const unsigned int finest = this->level_sizes.size() - 1;
+
+    Aggregate& leaf = this->aggregates[finest][channel * this->level_sizes[finest] + tile];
+    leaf.sum = leaf.min = leaf.max = value;
+
+    // walk up the tree until an aggregate remains unchanged
+    unsigned int node = tile;
+    for(unsigned int l=finest; l>0; l--) {
+        if(node >= this->level_sizes[l-1]) {
+            node = this->parents[node];
+        }
+
+        if(!this->combine(channel, l-1, node)) {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief       set the values of all tiles and rebuild the tree
+ *
+ * @param       channel     channel id
+ * @param       values      array holding a value for every tile
+ */
+void TileSummary::rebuild(unsigned int channel, const float* values) {
+    const unsigned int finest = this->level_sizes.size() - 1;
+
+    Aggregate* leaves = &this->aggregates[finest][channel * this->level_sizes[finest]];
+    for(unsigned int i=0; i<this->level_sizes[finest]; i++) {
+        leaves[i].sum = leaves[i].min = leaves[i].max = values[i];
+    }
+
+    for(unsigned int l=finest; l>0; l--) {
+        for(unsigned int node=0; node<this->level_sizes[l-1]; node++) {
+            this->combine(channel, l-1, node);
+        }
+    }
+}
+
+/**
+ * @brief       get the node at a coarser level that contains a tile
+ *
+ * @param       tile        tile id
+ * @param       level       level of the node
+ *
+ * @return      node id
+ */
+unsigned int TileSummary::get_ancestor(unsigned int tile, unsigned int level) const {
+    unsigned int node = tile;
+    for(unsigned int l=this->level_sizes.size()-1; l>level; l--) {
+        if(node >= this->level_sizes[l-1]) {
+            node = this->parents[node];
+        }
+    }
+
+    return node;
+}
+
+/**
+ * @brief       recompute the aggregate of a node from its children
+ *
+ * @param       channel     channel id
+ * @param       level       level of the node (not the finest level)
+ * @param       node        node id
+ *
+ * @return      whether the aggregate changed
+ */
+bool TileSummary::combine(unsigned int channel, unsigned int level, unsigned int node) {
+    const Aggregate* fine = &this->aggregates[level+1][channel * this->level_sizes[level+1]];
+    const std::vector<unsigned int>& offsets = this->child_offsets[level];
+
+    Aggregate result = fine[this->children[level][offsets[node]]];
+    for(unsigned int i=offsets[node]+1; i<offsets[node+1]; i++) {
+        const Aggregate& child = fine[this->children[level][i]];
+        result.sum += child.sum;
+        result.min = std::min(result.min, child.min);
+        result.max = std::max(result.max, child.max);
+    }
+
+    Aggregate& current = this->aggregates[level][channel * this->level_sizes[level] + node];
+    const bool changed = (current.sum != result.sum || current.min != result.min || current.max != result.max);
+    current = result;
+
+    return changed;
+}
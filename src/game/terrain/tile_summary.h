@@ -0,0 +1,146 @@
+/**************************************************************************
+ *   tile_summary.h  --  This file is part of Acardov.                    *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _TILE_SUMMARY_H
+#define _TILE_SUMMARY_H
+
+#include <vector>
+#include <algorithm>
+
+/**
+ * @class TileSummary
+ * @brief Tree of aggregates following the subdivision hierarchy of the tiles
+ *
+ * Every subdivision keeps the existing vertices and adds a vertex on each
+ * edge, hence the tiles of level l are the first level_sizes[l] tiles of the
+ * finest level. A node at level l is the parent of itself at level l+1 and
+ * of the new tiles that were split from it. Each node caches the sum,
+ * minimum and maximum of the leaves below it, such that regional queries
+ * and the propagation of a single change cost O(log n).
+ */
+class TileSummary {
+public:
+    /**
+     * @struct Aggregate
+     * @brief  summary of the values of all leaves below a node
+     */
+    struct Aggregate {
+        float sum;
+        float min;
+        float max;
+    };
+
+private:
+    unsigned int nr_channels;                                   //!< number of quantities that are summarized
+    std::vector<unsigned int> parents;                          //!< parent of each tile at the previous level
+    std::vector<unsigned int> level_sizes;                      //!< number of nodes per level
+
+    std::vector<std::vector<unsigned int> > child_offsets;      //!< CSR offsets of the children per level
+    std::vector<std::vector<unsigned int> > children;           //!< children per level (nodes at the next level)
+
+    std::vector<std::vector<Aggregate> > aggregates;            //!< aggregates per level, stored per channel
+
+public:
+    /**
+     * @brief       construct the summary tree
+     *
+     * @param       _parents        parent of each tile at the previous level
+     * @param       _level_sizes    number of tiles per level
+     * @param       _nr_channels    number of quantities to summarize
+     */
+    TileSummary(const std::vector<unsigned int>& _parents,
+                const std::vector<unsigned int>& _level_sizes,
+                unsigned int _nr_channels);
+
+    /**
+     * @brief       set the value of a single tile and update its ancestors
+     *
+     * @param       channel     channel id
+     * @param       tile        tile id
+     * @param       value       new value
+     */
+    void set_value(unsigned int channel, unsigned int tile, float value);
+
+    /**
+     * @brief       set the values of all tiles and rebuild the tree
+     *
+     * @param       channel     channel id
+     * @param       values      array holding a value for every tile
+     */
+    void rebuild(unsigned int channel, const float* values);
+
+    /**
+     * @brief       get the node at a coarser level that contains a tile
+     *
+     * @param       tile        tile id
+     * @param       level       level of the node
+     *
+     * @return      node id
+     */
+    unsigned int get_ancestor(unsigned int tile, unsigned int level) const;
+
+    /**
+     * @brief       get the aggregate of a node
+     *
+     * @param       channel     channel id
+     * @param       level       level of the node
+     * @param       node        node id
+     *
+     * @return      aggregate of all tiles below the node
+     */
+    inline const Aggregate& get_aggregate(unsigned int channel, unsigned int level, unsigned int node) const {
+        return this->aggregates[level][channel * this->level_sizes[level] + node];
+    }
+
+    /**
+     * @brief       get the aggregate of the region at a level that contains a tile
+     *
+     * @param       channel     channel id
+     * @param       tile        tile id
+     * @param       level       level of the region (0 is coarsest)
+     *
+     * @return      aggregate of all tiles in the region
+     */
+    inline const Aggregate& query(unsigned int channel, unsigned int tile, unsigned int level) const {
+        return this->get_aggregate(channel, level, this->get_ancestor(tile, level));
+    }
+
+    inline unsigned int get_nr_levels() const {
+        return this->level_sizes.size();
+    }
+
+    inline unsigned int get_level_size(unsigned int level) const {
+        return this->level_sizes[level];
+    }
+
+private:
+    /**
+     * @brief       recompute the aggregate of a node from its children
+     *
+     * @param       channel     channel id
+     * @param       level       level of the node (not the finest level)
+     * @param       node        node id
+     *
+     * @return      whether the aggregate changed
+     */
+    bool combine(unsigned int channel, unsigned int level, unsigned int node);
+};
+
+#endif //_TILE_SUMMARY_H
@@ -18,11 +18,47 @@
  *                                                                        *
  **************************************************************************/
 
+#include <string>
+#include <limits>
+#include <boost/lexical_cast.hpp>
+
 #include "core/asset_manager.h"
+#include "core/headless.h"
 #include "core/visualizer.h"
 
 int main(int argc, char* argv[]) {
     AssetManager::get().init(argv[0]);
 
+    // usage: acardov --headless [number of updates]
+    if(argc > 1 && std::string(argv[1]) == "--headless") {
+        unsigned long int nr_ticks = 10000;
+        if(argc > 2) {
+            try {
+                nr_ticks = boost::lexical_cast<unsigned long int>(argv[2]);
+            } catch(const boost::bad_lexical_cast&) {
+                std::cerr << "Invalid number of updates: " << argv[2] << std::endl;
+                return -1;
+            }
+        }
+
+        Headless::get().run(nr_ticks, 1.0 / 60.0);
+        return 0;
+    }
+
+    // usage: acardov --replay <command log> [update to stop at]
+    if(argc > 2 && std::string(argv[1]) == "--replay") {
+        unsigned long int update = std::numeric_limits<unsigned long int>::max();
+        if(argc > 3) {
+            try {
+                update = boost::lexical_cast<unsigned long int>(argv[3]);
+            } catch(const boost::bad_lexical_cast&) {
+                std::cerr << "Invalid update: " << argv[3] << std::endl;
+                return -1;
+            }
+        }
+
+        return Headless::get().replay(argv[2], update) ? 0 : -1;
+    }
+
     Visualizer::get().run(argc, argv);
 }
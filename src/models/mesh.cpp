@@ -37,43 +37,56 @@ Mesh::Mesh(const std::string& filename) {
  * @brief      draw the mesh
  */
 void Mesh::draw() const {
-    // load the vertex array
-    glBindVertexArray(this->vao);
+    // load the vertex array of the pool
+    GLState::get().bind_vertex_array(MeshPool::get().get_vao());
 
     // draw the mesh using the indices
-    glDrawElements(GL_TRIANGLES, this->indices.size(), GL_UNSIGNED_INT, 0);
-
-    // after this command, any commands that use a vertex array will
-    // no longer work
-    glBindVertexArray(0);
+    glDrawElementsBaseVertex(GL_TRIANGLES, this->range.nr_indices, GL_UNSIGNED_INT,
+                             (GLvoid*)(this->range.first_index * sizeof(unsigned int)), this->range.base_vertex);
 }
 
 /**
- * @brief      center the vertex coordinates around the origin in model space
+ * @brief      submit the queued instances as a single draw and clear the queue
+ *
+ * @param[in]  program  shader program to draw the instances with
  */
-void Mesh::center() {
-    double sum_x = 0.0;
-    double sum_y = 0.0;
-    double sum_z = 0.0;
-
-    for(unsigned int i=0; i<this->positions.size(); i++) {
-        sum_x += this->positions[i].x;
-        sum_y += this->positions[i].y;
-        sum_z += this->positions[i].z;
+void Mesh::submit_instances(GLuint program) {
+    if(this->instances.empty()) {
+        return;
     }
 
-    double n_items = (double)this->positions.size();
-    glm::vec3 center(sum_x / n_items,
-                     sum_y / n_items,
-                     sum_z / n_items);
+    // keep the instances until the render queue draws them
+    this->submitted.swap(this->instances);
+    this->instances.clear();
+
+    DrawItem item = DrawItem();
+    item.program = program;
+    item.vao = MeshPool::get().get_vao();
+    item.mode = GL_TRIANGLES;
+    item.count = this->range.nr_indices;
+    item.offset = (GLvoid*)(this->range.first_index * sizeof(unsigned int));
+    item.base_vertex = this->range.base_vertex;
+    item.nr_instances = this->submitted.size();
+    item.prepare = &Mesh::prepare_instances;
+    item.owner = this;
+    RenderQueue::get().submit(RenderQueue::PASS_OPAQUE, 0, item);
+}
 
-    for(unsigned int i=0; i<this->positions.size(); i++) {
-        this->positions[i] -= center;
-    }
+/**
+ * @brief      stream the submitted instances just before the render queue draws them
+ *
+ * All meshes share the instance buffer of the pool, hence the instances can
+ * only be uploaded right before the draw.
+ *
+ * @param[in]  item      draw item (the owner is the mesh)
+ */
+void Mesh::prepare_instances(const DrawItem& item) {
+    const Mesh* mesh = static_cast<const Mesh*>(item.owner);
+    MeshPool::get().upload_instances(&mesh->submitted[0], mesh->submitted.size());
 }
 
 Mesh::~Mesh() {
-
+    // the vertices and indices are owned by the mesh pool
 }
 
 /**
@@ -154,6 +167,7 @@ void Mesh::load_mesh_from_obj_file(const std::string& filename) {
         }
     }
 
+    // expand the faces into one vertex per corner
     if(_position_indices.size() > 0 && _texture_indices.size() > 0) {
         for(unsigned int i=0; i<_position_indices.size(); i++) {
             this->indices.push_back(i);
@@ -173,9 +187,17 @@ void Mesh::load_mesh_from_obj_file(const std::string& filename) {
         }
     }
 
+    // share the corners with identical attributes and order the triangles
+    // and vertices for the caches of the GPU
+    const unsigned int nr_corners = this->positions.size();
+    MeshOptimizer::weld(&this->positions, &this->normals, &this->texture_coordinates, &this->indices);
+    const float acmr = MeshOptimizer::get_acmr(this->indices, this->positions.size());
+    MeshOptimizer::optimize(&this->positions, &this->normals, &this->texture_coordinates, &this->indices);
+
     std::cout << "Model summary: " << filename << std::endl;
-    std::cout << "Positions: " << this->positions.size() << std::endl;
-    std::cout << "Normals: " << this->normals.size() << std::endl;
+    std::cout << "Vertices: " << this->positions.size() << " (welded from " << nr_corners << ")" << std::endl;
+    std::cout << "Triangles: " << this->indices.size() / 3 << std::endl;
+    std::cout << "ACMR: " << acmr << " -> " << MeshOptimizer::get_acmr(this->indices, this->positions.size()) << std::endl;
 }
 
 void Mesh::load_on_gpu() {
@@ -185,23 +207,16 @@ void Mesh::load_on_gpu() {
         exit(-1);
     }
 
-    // load vao and vbo
-    glGenVertexArrays(1, &this->vao);
-    glBindVertexArray(this->vao);
-    glGenBuffers(3, this->vbo);
-
-    glBindBuffer(GL_ARRAY_BUFFER, this->vbo[0]);
-    glBufferData(GL_ARRAY_BUFFER, this->positions.size() * 3 * sizeof(float), &this->positions[0][0], GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, this->vbo[1]);
-    glBufferData(GL_ARRAY_BUFFER, this->normals.size() * 3 * sizeof(float), &this->normals[0][0], GL_STATIC_DRAW);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->vbo[2]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->indices.size() * sizeof(unsigned int), &this->indices[0], GL_STATIC_DRAW);
-
-    glBindVertexArray(0);
+    // copy the mesh into the shared buffers
+    this->range = MeshPool::get().add(this->positions, this->normals, this->indices);
+
+    // the pool holds the only copy from here on
+    this->positions.clear();
+    this->positions.shrink_to_fit();
+    this->normals.clear();
+    this->normals.shrink_to_fit();
+    this->texture_coordinates.clear();
+    this->texture_coordinates.shrink_to_fit();
+    this->indices.clear();
+    this->indices.shrink_to_fit();
 }
@@ -25,6 +25,7 @@
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <cstddef>
 
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
@@ -37,16 +38,23 @@
 #include <boost/algorithm/string.hpp>
 
 #include "core/asset_manager.h"
+#include "core/render_queue.h"
+#include "core/gl_state.h"
+#include "models/mesh_pool.h"
+#include "models/mesh_optimizer.h"
 
 class Mesh {
 private:
+    // released once the mesh is copied into the mesh pool
     std::vector<glm::vec3> positions;                   //!< vector holding positions
     std::vector<glm::vec3> normals;                     //!< vector holding vertex normals
     std::vector<glm::vec2> texture_coordinates;         //!< vector holding texture coordinates
     std::vector<unsigned int> indices;                  //!< vector holding set of indices
 
-    GLuint vao;
-    GLuint vbo[3];
+    MeshRange range;                                    //!< location of the mesh in the mesh pool
+
+    std::vector<MeshInstance> instances;                //!< instances queued for the next draw
+    std::vector<MeshInstance> submitted;                //!< instances of the draw in the render queue
 
 public:
 
@@ -68,12 +76,26 @@ public:
     void draw() const;
 
     /**
-     * @brief      center the vertex coordinates around the origin in model space
+     * @brief      queue an instance of this mesh for the next instanced draw
+     *
+     * @param[in]  model     model matrix
+     * @param[in]  color     color of the instance
      */
-    void center();
+    inline void add_instance(const glm::mat4& model, const glm::vec3& color) {
+        this->instances.push_back(MeshInstance());
+        this->instances.back().model = model;
+        this->instances.back().color = pack_color(color);
+    }
+
+    /**
+     * @brief      submit the queued instances as a single draw and clear the queue
+     *
+     * @param[in]  program  shader program to draw the instances with
+     */
+    void submit_instances(GLuint program);
 
     inline void load_vao() const {
-        glBindVertexArray(this->vao);
+        GLState::get().bind_vertex_array(MeshPool::get().get_vao());
     }
 
     ~Mesh();
@@ -88,6 +110,13 @@ private:
     void load_mesh_from_obj_file(const std::string& filename);
 
     void load_on_gpu();
+
+    /**
+     * @brief      stream the submitted instances just before the render queue draws them
+     *
+     * @param[in]  item      draw item (the owner is the mesh)
+     */
+    static void prepare_instances(const DrawItem& item);
 };
 
 
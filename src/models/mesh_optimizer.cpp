@@ -0,0 +1,454 @@
+/**************************************************************************
+ *   mesh_optimizer.cpp  --  This file is part of Acardov.                *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+#include "models/mesh_optimizer.h"
+
+namespace {
+
+/**
+ * @struct WeldKey
+ * @brief  attributes of a vertex, compared bit for bit
+ */
+struct WeldKey {
+    float v[8];
+
+    bool operator==(const WeldKey& other) const {
+        return std::memcmp(this->v, other.v, sizeof(this->v)) == 0;
+    }
+};
+
+/**
+ * @struct WeldKeyHash
+ * @brief  FNV-1a hash over the bytes of the attributes
+ */
+struct WeldKeyHash {
+    size_t operator()(const WeldKey& key) const {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(key.v);
+        uint64_t hash = 0xCBF29CE484222325ULL;
+        for(unsigned int i=0; i<sizeof(key.v); i++) {
+            hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+        }
+        return (size_t)hash;
+    }
+};
+
+} // namespace
+
+/**
+ * @brief       merge the vertices with identical attributes
+ *
+ * @param       positions               vertex positions
+ * @param       normals                 vertex normals
+ * @param       texture_coordinates     texture coordinates (may be empty)
+ * @param       indices                 triangle indices (rewritten)
+ */
+void MeshOptimizer::weld(std::vector<glm::vec3>* positions,
+                         std::vector<glm::vec3>* normals,
+                         std::vector<glm::vec2>* texture_coordinates,
+                         std::vector<unsigned int>* indices) {
+    const bool has_texture = !texture_coordinates->empty();
+
+    std::unordered_map<WeldKey, unsigned int, WeldKeyHash> vertex_ids;
+    vertex_ids.reserve(positions->size());
+
+    std::vector<glm::vec3> welded_positions;
+    std::vector<glm::vec3> welded_normals;
+    std::vector<glm::vec2> welded_texture_coordinates;
+    std::vector<unsigned int> remap(positions->size());
+
+    for(unsigned int i=0; i<positions->size(); i++) {
+        WeldKey key;
+        for(unsigned int k=0; k<3; k++) {
+            // adding zero turns -0 into +0, such that both compare equal
+            key.v[k] = positions->at(i)[k] + 0.0f;
+            key.v[3 + k] = normals->at(i)[k] + 0.0f;
+        }
+        key.v[6] = has_texture ? texture_coordinates->at(i)[0] + 0.0f : 0.0f;
+        key.v[7] = has_texture ? texture_coordinates->at(i)[1] + 0.0f : 0.0f;
+
+        auto got = vertex_ids.insert(std::make_pair(key, (unsigned int)welded_positions.size()));
+        if(got.second) {
+            welded_positions.push_back(positions->at(i));
+            welded_normals.push_back(normals->at(i));
+            if(has_texture) {
+                welded_texture_coordinates.push_back(texture_coordinates->at(i));
+            }
+        }
+        remap[i] = got.first->second;
+    }
+
+    for(unsigned int i=0; i<indices->size(); i++) {
+        (*indices)[i] = remap[(*indices)[i]];
+    }
+
+    positions->swap(welded_positions);
+    normals->swap(welded_normals);
+    texture_coordinates->swap(welded_texture_coordinates);
+}
+
+/**
+ * @brief       run all optimization steps on a welded mesh
+ *
+ * @param       positions               vertex positions
+ * @param       normals                 vertex normals
+ * @param       texture_coordinates     texture coordinates (may be empty)
+ * @param       indices                 triangle indices
+ */
+void MeshOptimizer::optimize(std::vector<glm::vec3>* positions,
+                             std::vector<glm::vec3>* normals,
+                             std::vector<glm::vec2>* texture_coordinates,
+                             std::vector<unsigned int>* indices) {
+    optimize_vertex_cache(indices, positions->size());
+    optimize_overdraw(indices, *positions);
+    optimize_vertex_fetch(positions, normals, texture_coordinates, indices);
+}
+
+/**
+ * @brief       reorder the triangles for the post-transform vertex cache
+ *
+ * Greedily emits the triangle with the highest score, where the score of a
+ * triangle is the sum of the scores of its vertices. Vertices score high
+ * when they are recently used (in the modelled cache) and when few
+ * triangles still use them, such that lonely vertices are finished off
+ * rather than left behind.
+ *
+ * @param       indices                 triangle indices
+ * @param       nr_vertices             number of vertices
+ */
+void MeshOptimizer::optimize_vertex_cache(std::vector<unsigned int>* indices, size_t nr_vertices) {
+    static const unsigned int NONE = 0xFFFFFFFF;
+    const unsigned int nr_triangles = indices->size() / 3;
+    if(nr_triangles == 0) {
+        return;
+    }
+
+    // triangles using each vertex (compressed rows); the first valence[v]
+    // entries of a row are the triangles that are not yet emitted
+    std::vector<unsigned int> valence(nr_vertices, 0);
+    for(unsigned int i=0; i<nr_triangles * 3; i++) {
+        valence[(*indices)[i]]++;
+    }
+
+    std::vector<unsigned int> offsets(nr_vertices + 1, 0);
+    for(unsigned int v=0; v<nr_vertices; v++) {
+        offsets[v + 1] = offsets[v] + valence[v];
+    }
+
+    std::vector<unsigned int> adjacency(nr_triangles * 3);
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for(unsigned int i=0; i<nr_triangles * 3; i++) {
+        adjacency[fill[(*indices)[i]]++] = i / 3;
+    }
+
+    std::vector<int> cache_position(nr_vertices, -1);
+    std::vector<float> vertex_score(nr_vertices);
+    for(unsigned int v=0; v<nr_vertices; v++) {
+        vertex_score[v] = get_vertex_score(-1, valence[v]);
+    }
+
+    std::vector<float> triangle_score(nr_triangles);
+    std::vector<bool> emitted(nr_triangles, false);
+    unsigned int best = 0;
+    for(unsigned int t=0; t<nr_triangles; t++) {
+        triangle_score[t] = vertex_score[(*indices)[t * 3]] +
+                            vertex_score[(*indices)[t * 3 + 1]] +
+                            vertex_score[(*indices)[t * 3 + 2]];
+        if(triangle_score[t] > triangle_score[best]) {
+            best = t;
+        }
+    }
+
+    std::vector<unsigned int> cache;
+    std::vector<unsigned int> new_cache;
+    cache.reserve(CACHE_SIZE + 3);
+    new_cache.reserve(CACHE_SIZE + 3);
+
+    std::vector<unsigned int> result;
+    result.reserve(nr_triangles * 3);
+    unsigned int cursor = 0;
+
+    for(unsigned int n=0; n<nr_triangles; n++) {
+        if(best == NONE) {
+            // no candidate left around the cached vertices; continue
+            // with the first triangle that is not yet emitted
+            while(emitted[cursor]) {
+                cursor++;
+            }
+            best = cursor;
+        }
+
+        const unsigned int* triangle = &(*indices)[best * 3];
+        result.insert(result.end(), triangle, triangle + 3);
+        emitted[best] = true;
+
+        // the triangle no longer counts towards the valence of its vertices
+        for(unsigned int k=0; k<3; k++) {
+            const unsigned int v = triangle[k];
+            unsigned int* row = &adjacency[offsets[v]];
+            unsigned int* last = row + valence[v] - 1;
+            std::swap(*std::find(row, last, best), *last);
+            valence[v]--;
+        }
+
+        // the vertices of the triangle move to the front of the cache
+        new_cache.assign(triangle, triangle + 3);
+        for(unsigned int c: cache) {
+            if(c != triangle[0] && c != triangle[1] && c != triangle[2]) {
+                new_cache.push_back(c);
+            }
+        }
+
+        // rescore the vertices that were in or entered the cache (including
+        // the ones that just dropped out) and their triangles
+        for(unsigned int i=0; i<new_cache.size(); i++) {
+            const unsigned int v = new_cache[i];
+            cache_position[v] = i < CACHE_SIZE ? (int)i : -1;
+            vertex_score[v] = get_vertex_score(cache_position[v], valence[v]);
+        }
+
+        best = NONE;
+        float best_score = -1.0f;
+        for(unsigned int i=0; i<new_cache.size(); i++) {
+            const unsigned int v = new_cache[i];
+            for(unsigned int j=offsets[v]; j<offsets[v] + valence[v]; j++) {
+                const unsigned int t = adjacency[j];
+                triangle_score[t] = vertex_score[(*indices)[t * 3]] +
+                                    vertex_score[(*indices)[t * 3 + 1]] +
+                                    vertex_score[(*indices)[t * 3 + 2]];
+                if(triangle_score[t] > best_score) {
+                    best_score = triangle_score[t];
+                    best = t;
+                }
+            }
+        }
+
+        if(new_cache.size() > CACHE_SIZE) {
+            new_cache.resize(CACHE_SIZE);
+        }
+        cache.swap(new_cache);
+    }
+
+    indices->swap(result);
+}
+
+/**
+ * @brief       reorder clusters of triangles to reduce overdraw
+ *
+ * Clusters facing away from the center of the mesh are drawn first: for
+ * a (nearly) convex mesh these are the ones in front, which then occlude
+ * the rest.
+ *
+ * @param       indices                 triangle indices (ordered for the vertex cache)
+ * @param       positions               vertex positions
+ * @param       threshold               largest acceptable increase of the ACMR
+ */
+void MeshOptimizer::optimize_overdraw(std::vector<unsigned int>* indices,
+                                      const std::vector<glm::vec3>& positions,
+                                      float threshold) {
+    const unsigned int nr_triangles = indices->size() / 3;
+    if(nr_triangles == 0) {
+        return;
+    }
+
+    const std::vector<bool> restarts = get_cache_restarts(*indices, positions.size());
+    std::vector<unsigned int> cluster_offsets;
+    for(unsigned int t=0; t<nr_triangles; t++) {
+        if(restarts[t]) {
+            cluster_offsets.push_back(t);
+        }
+    }
+    cluster_offsets.push_back(nr_triangles);
+    const unsigned int nr_clusters = cluster_offsets.size() - 1;
+    if(nr_clusters < 2) {
+        return;
+    }
+
+    glm::vec3 mesh_center(0.0f);
+    for(const glm::vec3& position: positions) {
+        mesh_center += position;
+    }
+    mesh_center /= (float)positions.size();
+
+    // sort key: how much a cluster faces away from the center of the mesh
+    std::vector<std::pair<float, unsigned int> > clusters(nr_clusters);
+    for(unsigned int c=0; c<nr_clusters; c++) {
+        glm::vec3 center(0.0f);
+        glm::vec3 normal(0.0f);     // area weighted
+        float area = 0.0f;
+        for(unsigned int t=cluster_offsets[c]; t<cluster_offsets[c + 1]; t++) {
+            const glm::vec3& p0 = positions[(*indices)[t * 3]];
+            const glm::vec3& p1 = positions[(*indices)[t * 3 + 1]];
+            const glm::vec3& p2 = positions[(*indices)[t * 3 + 2]];
+            const glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            const float a = glm::length(n);
+            center += (p0 + p1 + p2) * (a / 3.0f);
+            normal += n;
+            area += a;
+        }
+
+        float key = 0.0f;
+        if(area > 0.0f && glm::length(normal) > 0.0f) {
+            key = glm::dot(center / area - mesh_center, glm::normalize(normal));
+        }
+        clusters[c] = std::make_pair(-key, c);
+    }
+    std::stable_sort(clusters.begin(), clusters.end());
+
+    std::vector<unsigned int> result;
+    result.reserve(indices->size());
+    for(unsigned int c=0; c<nr_clusters; c++) {
+        const unsigned int cluster = clusters[c].second;
+        result.insert(result.end(),
+                      indices->begin() + cluster_offsets[cluster] * 3,
+                      indices->begin() + cluster_offsets[cluster + 1] * 3);
+    }
+
+    if(get_acmr(result, positions.size()) <= get_acmr(*indices, positions.size()) * threshold) {
+        indices->swap(result);
+    }
+}
+
+/**
+ * @brief       store the vertices in the order they are first referenced
+ *
+ * Vertices that are not referenced at all are dropped.
+ *
+ * @param       positions               vertex positions
+ * @param       normals                 vertex normals
+ * @param       texture_coordinates     texture coordinates (may be empty)
+ * @param       indices                 triangle indices (rewritten)
+ */
+void MeshOptimizer::optimize_vertex_fetch(std::vector<glm::vec3>* positions,
+                                          std::vector<glm::vec3>* normals,
+                                          std::vector<glm::vec2>* texture_coordinates,
+                                          std::vector<unsigned int>* indices) {
+    static const unsigned int NONE = 0xFFFFFFFF;
+    const bool has_texture = !texture_coordinates->empty();
+
+    std::vector<unsigned int> remap(positions->size(), NONE);
+    std::vector<glm::vec3> new_positions;
+    std::vector<glm::vec3> new_normals;
+    std::vector<glm::vec2> new_texture_coordinates;
+    new_positions.reserve(positions->size());
+    new_normals.reserve(normals->size());
+    new_texture_coordinates.reserve(texture_coordinates->size());
+
+    for(unsigned int i=0; i<indices->size(); i++) {
+        const unsigned int v = (*indices)[i];
+        if(remap[v] == NONE) {
+            remap[v] = new_positions.size();
+            new_positions.push_back((*positions)[v]);
+            new_normals.push_back((*normals)[v]);
+            if(has_texture) {
+                new_texture_coordinates.push_back((*texture_coordinates)[v]);
+            }
+        }
+        (*indices)[i] = remap[v];
+    }
+
+    positions->swap(new_positions);
+    normals->swap(new_normals);
+    texture_coordinates->swap(new_texture_coordinates);
+}
+
+/**
+ * @brief       average cache miss ratio of a FIFO vertex cache
+ *
+ * @param       indices                 triangle indices
+ * @param       nr_vertices             number of vertices
+ *
+ * @return      vertex shader invocations per triangle
+ */
+float MeshOptimizer::get_acmr(const std::vector<unsigned int>& indices, size_t nr_vertices) {
+    if(indices.size() < 3) {
+        return 0.0f;
+    }
+
+    // a vertex is cached when it entered the FIFO less than FIFO_SIZE misses ago
+    std::vector<unsigned int> entered(nr_vertices, 0);
+    unsigned int misses = 0;
+    for(unsigned int i=0; i<indices.size(); i++) {
+        const unsigned int v = indices[i];
+        if(entered[v] == 0 || misses - entered[v] >= FIFO_SIZE) {
+            misses++;
+            entered[v] = misses;
+        }
+    }
+
+    return (float)misses / (float)(indices.size() / 3);
+}
+
+/**
+ * @brief       whether a triangle starts a fresh run of the FIFO vertex cache, for every triangle
+ *
+ * A triangle of which none of the vertices are cached does not depend on
+ * the triangles before it.
+ */
+std::vector<bool> MeshOptimizer::get_cache_restarts(const std::vector<unsigned int>& indices, size_t nr_vertices) {
+    std::vector<unsigned int> entered(nr_vertices, 0);
+    std::vector<bool> restarts(indices.size() / 3, false);
+    unsigned int misses = 0;
+    for(unsigned int t=0; t<indices.size() / 3; t++) {
+        unsigned int triangle_misses = 0;
+        for(unsigned int k=0; k<3; k++) {
+            const unsigned int v = indices[t * 3 + k];
+            if(entered[v] == 0 || misses - entered[v] >= FIFO_SIZE) {
+                misses++;
+                triangle_misses++;
+                entered[v] = misses;
+            }
+        }
+        restarts[t] = (triangle_misses == 3);
+    }
+
+    return restarts;
+}
+
+/**
+ * @brief       score of a vertex (Forsyth)
+ *
+ * @param       cache_position          position in the cache (-1 when not cached)
+ * @param       valence                 number of triangles still to be drawn using the vertex
+ */
+float MeshOptimizer::get_vertex_score(int cache_position, unsigned int valence) {
+    static const float CACHE_DECAY_POWER = 1.5f;
+    static const float LAST_TRIANGLE_SCORE = 0.75f;
+    static const float VALENCE_BOOST_SCALE = 2.0f;
+    static const float VALENCE_BOOST_POWER = 0.5f;
+
+    if(valence == 0) {
+        return -1.0f;   // no triangles left to draw
+    }
+
+    float score = 0.0f;
+    if(cache_position >= 0) {
+        if(cache_position < 3) {
+            // the vertices of the last triangle get a fixed score, such that
+            // the ordering does not prefer one of them
+            score = LAST_TRIANGLE_SCORE;
+        } else {
+            const float scale = 1.0f / (float)(CACHE_SIZE - 3);
+            score = std::pow(1.0f - (float)(cache_position - 3) * scale, CACHE_DECAY_POWER);
+        }
+    }
+
+    score += VALENCE_BOOST_SCALE * std::pow((float)valence, -VALENCE_BOOST_POWER);
+
+    return score;
+}
@@ -0,0 +1,145 @@
+/**************************************************************************
+ *   mesh_optimizer.h  --  This file is part of Acardov.                  *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+#ifndef _MESH_OPTIMIZER_H
+#define _MESH_OPTIMIZER_H
+
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+/**
+ * @class MeshOptimizer
+ * @brief Import-time optimization of indexed triangle meshes
+ *
+ * An imported mesh is processed in four steps:
+ *
+ * 1. weld:                 face corners with identical attributes share a vertex
+ * 2. vertex cache:         order the triangles such that the vertices of a
+ *                          triangle are likely still in the post-transform cache
+ *                          (Forsyth, "Linear-speed vertex cache optimisation")
+ * 3. overdraw:             draw outward facing clusters of triangles first,
+ *                          such that the depth test rejects more fragments
+ * 4. vertex fetch:         store the vertices in the order they are first used
+ *
+ * The efficiency of the cache is expressed as the average cache miss ratio
+ * (ACMR): the number of vertex shader invocations per triangle, between 0.5
+ * (ideal for large grids) and 3 (no reuse at all).
+ */
+class MeshOptimizer {
+private:
+    static const unsigned int CACHE_SIZE = 32;          //!< size of the modelled LRU cache of the ordering
+    static const unsigned int FIFO_SIZE = 16;           //!< size of the FIFO cache used for measuring
+
+public:
+    /**
+     * @brief       merge the vertices with identical attributes
+     *
+     * @param       positions               vertex positions
+     * @param       normals                 vertex normals
+     * @param       texture_coordinates     texture coordinates (may be empty)
+     * @param       indices                 triangle indices (rewritten)
+     */
+    static void weld(std::vector<glm::vec3>* positions,
+                     std::vector<glm::vec3>* normals,
+                     std::vector<glm::vec2>* texture_coordinates,
+                     std::vector<unsigned int>* indices);
+
+    /**
+     * @brief       run all optimization steps on a welded mesh
+     *
+     * @param       positions               vertex positions
+     * @param       normals                 vertex normals
+     * @param       texture_coordinates     texture coordinates (may be empty)
+     * @param       indices                 triangle indices
+     */
+    static void optimize(std::vector<glm::vec3>* positions,
+                         std::vector<glm::vec3>* normals,
+                         std::vector<glm::vec2>* texture_coordinates,
+                         std::vector<unsigned int>* indices);
+
+    /**
+     * @brief       reorder the triangles for the post-transform vertex cache
+     *
+     * @param       indices                 triangle indices
+     * @param       nr_vertices             number of vertices
+     */
+    static void optimize_vertex_cache(std::vector<unsigned int>* indices, size_t nr_vertices);
+
+    /**
+     * @brief       reorder clusters of triangles to reduce overdraw
+     *
+     * The triangles are split into clusters at the points where the vertex
+     * cache starts afresh, hence the clusters can be reordered at little
+     * cost to the cache efficiency. The reordering is dropped when it would
+     * raise the ACMR by more than the given factor.
+     *
+     * @param       indices                 triangle indices (ordered for the vertex cache)
+     * @param       positions               vertex positions
+     * @param       threshold               largest acceptable increase of the ACMR
+     */
+    static void optimize_overdraw(std::vector<unsigned int>* indices,
+                                  const std::vector<glm::vec3>& positions,
+                                  float threshold = 1.05f);
+
+    /**
+     * @brief       store the vertices in the order they are first referenced
+     *
+     * @param       positions               vertex positions
+     * @param       normals                 vertex normals
+     * @param       texture_coordinates     texture coordinates (may be empty)
+     * @param       indices                 triangle indices (rewritten)
+     */
+    static void optimize_vertex_fetch(std::vector<glm::vec3>* positions,
+                                      std::vector<glm::vec3>* normals,
+                                      std::vector<glm::vec2>* texture_coordinates,
+                                      std::vector<unsigned int>* indices);
+
+    /**
+     * @brief       average cache miss ratio of a FIFO vertex cache
+     *
+     * @param       indices                 triangle indices
+     * @param       nr_vertices             number of vertices
+     *
+     * @return      vertex shader invocations per triangle
+     */
+    static float get_acmr(const std::vector<unsigned int>& indices, size_t nr_vertices);
+
+private:
+    /**
+     * @brief       score of a vertex (Forsyth)
+     *
+     * @param       cache_position          position in the cache (-1 when not cached)
+     * @param       valence                 number of triangles still to be drawn using the vertex
+     */
+    static float get_vertex_score(int cache_position, unsigned int valence);
+
+    /**
+     * @brief       whether a triangle starts a fresh run of the FIFO vertex cache, for every triangle
+     */
+    static std::vector<bool> get_cache_restarts(const std::vector<unsigned int>& indices, size_t nr_vertices);
+};
+
+#endif //_MESH_OPTIMIZER_H
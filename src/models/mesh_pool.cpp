@@ -0,0 +1,176 @@
+/**************************************************************************
+ *   mesh_pool.cpp  --  This file is part of Acardov.                     *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+#include "models/mesh_pool.h"
+
+MeshPool::MeshPool() :
+    nr_vertices(0),
+    vertex_capacity(0),
+    nr_indices(0),
+    index_capacity(0) {
+    glGenVertexArrays(1, &this->vao);
+    glGenBuffers(NR_BUFFERS, this->vbo);
+    glGenBuffers(1, &this->vbo_instances);
+
+    // room for the typical set of piece meshes
+    this->reserve(1 << 15, 1 << 16);
+}
+
+/**
+ * @brief       copy a mesh into the pool
+ *
+ * @param       positions       vertex positions
+ * @param       normals         vertex normals
+ * @param       indices         triangle indices (relative to the first vertex of the mesh)
+ *
+ * @return      location of the mesh in the pool
+ */
+MeshRange MeshPool::add(const std::vector<glm::vec3>& positions,
+                        const std::vector<glm::vec3>& normals,
+                        const std::vector<unsigned int>& indices) {
+    if(positions.size() != normals.size()) {
+        std::cerr << "[ERROR] Mesh has " << positions.size() << " positions but "
+                  << normals.size() << " normals" << std::endl;
+        exit(-1);
+    }
+
+    this->reserve(positions.size(), indices.size());
+
+    MeshRange range;
+    range.base_vertex = this->nr_vertices;
+    range.first_index = this->nr_indices;
+    range.nr_indices = indices.size();
+
+    std::vector<VertexPN> vertices(positions.size());
+    for(unsigned int i=0; i<positions.size(); i++) {
+        vertices[i].position = positions[i];
+        vertices[i].normal = pack_normal(normals[i]);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->vbo[VERTICES]);
+    glBufferSubData(GL_ARRAY_BUFFER, this->nr_vertices * sizeof(VertexPN), vertices.size() * sizeof(VertexPN), &vertices[0]);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // the element buffer is part of the vertex array state
+    GLState::get().bind_vertex_array(this->vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->vbo[INDICES]);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, this->nr_indices * sizeof(unsigned int), indices.size() * sizeof(unsigned int), &indices[0]);
+    GLState::get().bind_vertex_array(0);
+
+    this->nr_vertices += positions.size();
+    this->nr_indices += indices.size();
+
+    return range;
+}
+
+/**
+ * @brief       stream the per-instance data for the next instanced draw
+ *
+ * Respecifying the store lets the driver orphan the buffer that may still
+ * be in use by a previous draw, so the draws do not have to wait for each other.
+ *
+ * @param       instances       per-instance data
+ * @param       nr_instances    number of instances
+ */
+void MeshPool::upload_instances(const MeshInstance* instances, size_t nr_instances) {
+    glBindBuffer(GL_ARRAY_BUFFER, this->vbo_instances);
+    glBufferData(GL_ARRAY_BUFFER, nr_instances * sizeof(MeshInstance), instances, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/**
+ * @brief       make sure the buffers have room for a number of additional vertices and indices
+ */
+void MeshPool::reserve(GLint extra_vertices, GLuint extra_indices) {
+    bool grown = false;
+
+    if(this->nr_vertices + extra_vertices > this->vertex_capacity) {
+        GLint capacity = std::max(this->vertex_capacity, 1);
+        while(capacity < this->nr_vertices + extra_vertices) {
+            capacity *= 2;
+        }
+
+        grow_buffer(&this->vbo[VERTICES], this->nr_vertices * sizeof(VertexPN), capacity * sizeof(VertexPN));
+        this->vertex_capacity = capacity;
+        grown = true;
+    }
+
+    if(this->nr_indices + extra_indices > this->index_capacity) {
+        GLuint capacity = std::max(this->index_capacity, 1u);
+        while(capacity < this->nr_indices + extra_indices) {
+            capacity *= 2;
+        }
+
+        grow_buffer(&this->vbo[INDICES], this->nr_indices * sizeof(unsigned int), capacity * sizeof(unsigned int));
+        this->index_capacity = capacity;
+        grown = true;
+    }
+
+    if(grown) {
+        this->set_attributes();
+    }
+}
+
+/**
+ * @brief       move a buffer into a larger one, keeping its contents
+ *
+ * @param       buffer          buffer (replaced by the new one)
+ * @param       used_bytes      bytes to keep
+ * @param       new_bytes       size of the new buffer
+ */
+void MeshPool::grow_buffer(GLuint* buffer, size_t used_bytes, size_t new_bytes) {
+    GLuint new_buffer;
+    glGenBuffers(1, &new_buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, new_buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, new_bytes, NULL, GL_STATIC_DRAW);
+
+    if(used_bytes > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, *buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used_bytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, buffer);
+    *buffer = new_buffer;
+}
+
+/**
+ * @brief       point the vertex attributes of the vertex array at the buffers
+ */
+void MeshPool::set_attributes() {
+    GLState::get().bind_vertex_array(this->vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->vbo[VERTICES]);
+    LayoutPN::set_attributes();
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->vbo[INDICES]);
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->vbo_instances);
+    LayoutInstance::set_attributes(1);
+
+    GLState::get().bind_vertex_array(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+MeshPool::~MeshPool() {
+    glDeleteBuffers(NR_BUFFERS, this->vbo);
+    glDeleteBuffers(1, &this->vbo_instances);
+    glDeleteVertexArrays(1, &this->vao);
+}
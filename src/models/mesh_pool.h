@@ -0,0 +1,160 @@
+/**************************************************************************
+ *   mesh_pool.h  --  This file is part of Acardov.                       *
+ *                                                                        *
+ *   Copyright (C) 2016, Ivo Filot                                        *
+ *                                                                        *
+ *   Acardov is free software: you can redistribute it and/or modify      *
+ *   it under the terms of the GNU General Public License as published    *
+ *   by the Free Software Foundation, either version 3 of the License,    *
+ *   or (at your option) any later version.                               *
+ *                                                                        *
+ *   Acardov is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+#ifndef _MESH_POOL_H
+#define _MESH_POOL_H
+
+#include <vector>
+#include <iostream>
+#include <cstddef>
+#include <algorithm>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+
+#include "core/gl_state.h"
+#include "core/vertex_layout.h"
+
+/**
+ * @struct MeshInstance
+ * @brief  per-instance data of an instanced draw
+ */
+struct MeshInstance {
+    glm::mat4 model;        //!< model matrix
+    glm::u8vec4 color;      //!< color of the instance (see pack_color)
+};
+
+typedef VertexLayout<MeshInstance,
+                     VertexAttribute<2, PackedColor, offsetof(MeshInstance, color)>,
+                     VertexAttribute<3, Float4x4, offsetof(MeshInstance, model)> > LayoutInstance;
+
+/**
+ * @struct MeshRange
+ * @brief  location of a mesh in the buffers of the mesh pool
+ */
+struct MeshRange {
+    GLint base_vertex;      //!< position of the first vertex in the vertex buffers
+    GLuint first_index;     //!< position of the first index in the index buffer
+    GLsizei nr_indices;     //!< number of indices
+};
+
+/**
+ * @class MeshPool
+ * @brief Shared buffers holding the vertices and indices of all static meshes
+ *
+ * Every mesh is suballocated from the same vertex and index buffers, which
+ * are described by a single vertex array object. The indices of a mesh are
+ * relative to its first vertex; the meshes are drawn with the base vertex
+ * variants of the draw calls, hence switching between meshes requires no
+ * state change at all. The per-instance data of instanced draws is streamed
+ * through a single instance buffer, attached to the same vertex array.
+ *
+ * Vertex layout: position (location 0) and packed normal (location 1) per
+ * vertex, interleaved in a single buffer (LayoutPN); packed color (location 2)
+ * and model matrix (locations 3-6) per instance (LayoutInstance).
+ *
+ * Static meshes are never released; the buffers grow (by copying on the GPU)
+ * when they run out of room.
+ */
+class MeshPool {
+private:
+    enum {
+        VERTICES,
+        INDICES,
+
+        NR_BUFFERS
+    };
+
+    GLuint vao;                         //!< vertex array object describing the pool
+    GLuint vbo[NR_BUFFERS];             //!< vertex and index buffers
+    GLuint vbo_instances;               //!< buffer holding the per-instance data
+
+    GLint nr_vertices;                  //!< vertices in use
+    GLint vertex_capacity;              //!< vertices that fit in the vertex buffers
+    GLuint nr_indices;                  //!< indices in use
+    GLuint index_capacity;              //!< indices that fit in the index buffer
+
+public:
+    /**
+     * @fn          get
+     *
+     * @brief       get a reference to the mesh pool
+     *
+     * @return      reference to the mesh pool object (singleton pattern)
+     */
+    static MeshPool& get() {
+        static MeshPool mesh_pool_instance;
+        return mesh_pool_instance;
+    }
+
+    /**
+     * @brief       copy a mesh into the pool
+     *
+     * @param       positions       vertex positions
+     * @param       normals         vertex normals
+     * @param       indices         triangle indices (relative to the first vertex of the mesh)
+     *
+     * @return      location of the mesh in the pool
+     */
+    MeshRange add(const std::vector<glm::vec3>& positions,
+                  const std::vector<glm::vec3>& normals,
+                  const std::vector<unsigned int>& indices);
+
+    /**
+     * @brief       stream the per-instance data for the next instanced draw
+     *
+     * @param       instances       per-instance data
+     * @param       nr_instances    number of instances
+     */
+    void upload_instances(const MeshInstance* instances, size_t nr_instances);
+
+    inline GLuint get_vao() const {
+        return this->vao;
+    }
+
+    ~MeshPool();
+
+private:
+    MeshPool();
+
+    /**
+     * @brief       make sure the buffers have room for a number of additional vertices and indices
+     */
+    void reserve(GLint extra_vertices, GLuint extra_indices);
+
+    /**
+     * @brief       move a buffer into a larger one, keeping its contents
+     *
+     * @param       buffer          buffer (replaced by the new one)
+     * @param       used_bytes      bytes to keep
+     * @param       new_bytes       size of the new buffer
+     */
+    static void grow_buffer(GLuint* buffer, size_t used_bytes, size_t new_bytes);
+
+    /**
+     * @brief       point the vertex attributes of the vertex array at the buffers
+     */
+    void set_attributes();
+
+    MeshPool(MeshPool const&)          = delete;
+    void operator=(MeshPool const&)  = delete;
+};
+
+#endif //_MESH_POOL_H
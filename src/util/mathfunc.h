@@ -28,9 +28,6 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
-#include <boost/serialization/split_free.hpp>
-#include <boost/serialization/vector.hpp>
-
 /**
  * @fn square
  * @brief Convenience function that returns the square of a double